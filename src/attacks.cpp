@@ -2,6 +2,11 @@
 #include "bits.h"
 #include "lookup.h"
 #include "magics.h"
+#include <array>
+
+#ifdef USE_PEXT
+#include <immintrin.h>
+#endif
 
 enum Directions {
     northwest,
@@ -52,49 +57,79 @@ template <bool side> u64 forward_attacks(u64 occ, int square) {
 template u64 forward_attacks<false>(u64 occ, int square);
 template u64 forward_attacks<true>(u64 occ, int square);
 
-void init_magics() {
-    for (int slider_loc{}; slider_loc < 64; ++slider_loc) { //bishops
-        u64 attack_mask = bishop_premask[slider_loc];
-        int num_sets = (1 << popcount(attack_mask));
-        u64 temp;
-        for (int index{}; index < num_sets; ++index) {
-            temp = attack_mask;
-            u64 occupancy = 0;
-            int square{};
-            for (int count = 0; count < popcount(attack_mask); count++) {
-                square = pop_lsb(temp);
-                if (index & (1 << count)) occupancy |= (1ull << square);
-            }
-            u64 magic_index = (occupancy * bishop_magics[slider_loc].magic) >> 55;
-            lookup_table[bishop_magics[slider_loc].start + magic_index] = classical_bishop_attacks(occupancy, slider_loc);
-        }
-    }
-    for (int slider_loc{}; slider_loc < 64; ++slider_loc) { //rooks
-        u64 attack_mask = rook_premask[slider_loc];
-        int num_sets = (1 << popcount(attack_mask));
-        u64 temp;
-        for (int index{}; index < num_sets; ++index) {
-            temp = attack_mask;
-            u64 occupancy = 0;
-            int square{};
-            for (int count = 0; count < popcount(attack_mask); count++) {
-                square = pop_lsb(temp);
-                if (index & (1 << count)) occupancy |= (1ull << square);
-            }
-            u64 magic_index = (occupancy * rook_magics[slider_loc].magic >> 52);
-            lookup_table[rook_magics[slider_loc].start + magic_index] = classical_rook_attacks(occupancy, slider_loc);
-        }
+#ifdef USE_PEXT
+
+//pext of the premask indexes a dense block per square, the entries hold the attacks compressed by pext of the empty board attacks
+struct Pext_entry {
+    u64 premask;
+    u64 attack_mask;
+    int start;
+};
+
+struct Pext_tables {
+    Pext_entry rooks[64];
+    Pext_entry bishops[64];
+    std::array<u16, pext_table_size> attacks;
+};
+
+static void fill_pext(Pext_tables& tables, Pext_entry* entries, const u64* premasks, u64 (*attacks)(u64, int), int& start) {
+    for (int square{}; square < 64; ++square) {
+        entries[square] = {premasks[square], attacks(0, square), start};
+        u64 occupancy = 0;
+        do {
+            tables.attacks[start + _pext_u64(occupancy, premasks[square])] = _pext_u64(attacks(occupancy, square), entries[square].attack_mask);
+            occupancy = (occupancy - premasks[square]) & premasks[square];
+        } while (occupancy);
+        start += 1 << popcount(premasks[square]);
     }
 }
 
-u64 classical_rook_attacks(u64 occ, int square) {
-    return file_attacks(occ, square) | rank_attacks(occ, square);
+static Pext_tables make_pext_tables() {
+    Pext_tables tables{};
+    int start{};
+    fill_pext(tables, tables.rooks, rook_premask, classical_rook_attacks, start);
+    fill_pext(tables, tables.bishops, bishop_premask, classical_bishop_attacks, start);
+    return tables;
 }
 
-u64 classical_bishop_attacks(u64 occ, int square) {
-    return diagonal_attacks(occ, square) | antidiagonal_attacks(occ, square);
+//built once during static initialization, nothing may look up slider attacks before main
+static const Pext_tables pext_tables = make_pext_tables();
+
+static inline u64 pext_attacks(const Pext_entry& entry, u64 occ) {
+    return _pdep_u64(pext_tables.attacks[entry.start + _pext_u64(occ, entry.premask)], entry.attack_mask);
+}
+
+u64 rook_attacks(u64 occ, int square) {
+    return pext_attacks(pext_tables.rooks[square], occ);
+}
+
+u64 bishop_attacks(u64 occ, int square) {
+    return pext_attacks(pext_tables.bishops[square], occ);
+}
+
+#else
+
+//fills the entries of one slider's magics with the attack sets of every subset of its premasks
+template <int shift> static void fill_magics(std::array<u64, lookup_table_size>& table, const u64* premasks, const Magic* magics, u64 (*attacks)(u64, int)) {
+    for (int square{}; square < 64; ++square) {
+        u64 occupancy = 0;
+        do {
+            table[magics[square].start + (occupancy * magics[square].magic >> shift)] = attacks(occupancy, square);
+            occupancy = (occupancy - premasks[square]) & premasks[square];
+        } while (occupancy);
+    }
 }
 
+static std::array<u64, lookup_table_size> make_lookup_table() {
+    std::array<u64, lookup_table_size> table{};
+    fill_magics<55>(table, bishop_premask, bishop_magics, classical_bishop_attacks);
+    fill_magics<52>(table, rook_premask, rook_magics, classical_rook_attacks);
+    return table;
+}
+
+//built once during static initialization, the one copy in the program, nothing may look up slider attacks before main
+static const std::array<u64, lookup_table_size> lookup_table = make_lookup_table();
+
 u64 rook_attacks(u64 occ, int square) {
     return lookup_table[rook_magics[square].start + ((occ & rook_premask[square]) * rook_magics[square].magic >> 52)];
 }
@@ -103,6 +138,16 @@ u64 bishop_attacks(u64 occ, int square) {
     return lookup_table[bishop_magics[square].start + ((occ & bishop_premask[square]) * bishop_magics[square].magic >> 55)];
 }
 
+#endif
+
+u64 classical_rook_attacks(u64 occ, int square) {
+    return file_attacks(occ, square) | rank_attacks(occ, square);
+}
+
+u64 classical_bishop_attacks(u64 occ, int square) {
+    return diagonal_attacks(occ, square) | antidiagonal_attacks(occ, square);
+}
+
 u64 queen_attacks(u64 occ, int square) {
     return rook_attacks(occ, square) | bishop_attacks(occ, square);
 }
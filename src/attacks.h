@@ -3,6 +3,13 @@
 
 #include "types.h"
 
+//PEXT=yes builds the slider attacks on BMI2 pext and pdep, otherwise they use fixed-shift magics
+#ifdef USE_PEXT
+constexpr const char* slider_backend = "pext";
+#else
+constexpr const char* slider_backend = "magic";
+#endif
+
 u64 positive_ray_attacks(u64 occ, int direction, int square);
 u64 negative_ray_attacks(u64 occ, int direction, int square);
 u64 diagonal_attacks(u64 occ, int square);
@@ -10,7 +17,6 @@ u64 antidiagonal_attacks(u64 occ, int square);
 u64 rank_attacks(u64 occ, int square);
 u64 file_attacks(u64 occ, int square);
 template <bool side> u64 forward_attacks(u64 occ, int square);
-void init_magics();
 u64 classical_rook_attacks(u64 occ, int square);
 u64 classical_bishop_attacks(u64 occ, int square);
 u64 rook_attacks(u64 occ, int square);
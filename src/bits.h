@@ -13,10 +13,12 @@ inline int pop_lsb(u64& bits) {
     bits &= bits - 1;
     return lsb;
 }
+inline void prefetch(const void* address) {__builtin_prefetch(address);}
 
 #elif defined(_MSC_VER)
 
 #include <intrin.h>
+#include <xmmintrin.h>
 
 inline int popcount(u64 bits) {return __popcnt64(bits);}
 inline int get_lsb(u64 bits) {return _BitScanForward64(bits);}
@@ -26,6 +28,7 @@ inline int pop_lsb(u64& bits) {
     __blsr_u64(bits);
     return lsb;
 }
+inline void prefetch(const void* address) {_mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);}
 
 #else
 
@@ -39,6 +42,7 @@ inline int pop_lsb(u64& bits) {
     bits &= bits - 1;
     return lsb;
 }
+inline void prefetch(const void*) {}
 
 #endif
 
@@ -1,13 +1,17 @@
 #include "attacks.h"
 #include "bits.h"
 #include "board.h"
+#include "endgame.h"
 #include "lookup.h"
 #include "nnue.h"
 #include "zobrist.h"
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <cstring>
+#include <utility>
 
 Position::Position() {
-    init_magics();
     recalculate_zobrist();
 }
 
@@ -30,18 +34,240 @@ u64 Position::checkers(u64 occ) {
 }
 
 bool Position::check() {
-    return checkers(occupied);
+    Check_info& info = check_infos[ply];
+    if (!(info.known & checkers_known)) {
+        info.checkers = checkers(occupied());
+        info.known |= checkers_known;
+    }
+    return info.checkers;
+}
+
+//every square a side attacks, sliders looking through the given occupancy
+template <bool side> u64 Position::attacked_squares(u64 occ) {
+    constexpr u64 not_a_file = 0xfefefefefefefefe;
+    constexpr u64 not_h_file = 0x7f7f7f7f7f7f7f7f;
+    const u64 pawns = pieces[black_pawn + side];
+    u64 attacked;
+    if constexpr (side) attacked = ((pawns & not_a_file) >> 9) | ((pawns & not_h_file) >> 7);
+    else attacked = ((pawns & not_a_file) << 7) | ((pawns & not_h_file) << 9);
+    attacked |= king_attacks[get_lsb(pieces[black_king + side])];
+    u64 attackers = pieces[black_knight + side];
+    while (attackers) attacked |= knight_attacks[pop_lsb(attackers)];
+    attackers = pieces[black_bishop + side] | pieces[black_queen + side];
+    while (attackers) attacked |= bishop_attacks(occ, pop_lsb(attackers));
+    attackers = pieces[black_rook + side] | pieces[black_queen + side];
+    while (attackers) attacked |= rook_attacks(occ, pop_lsb(attackers));
+    return attacked;
+}
+
+template u64 Position::attacked_squares<false>(u64 occ);
+template u64 Position::attacked_squares<true>(u64 occ);
+
+void Position::update_check_info() {
+    Check_info& info = check_infos[ply];
+    const bool side = side_to_move;
+    const int king_location = get_lsb(pieces[black_king + side]);
+    const int enemy_king = get_lsb(pieces[black_king + !side]);
+    const u64 own_pieces = colors[side];
+    if (!(info.known & checkers_known)) info.checkers = attacks_to(king_location, occupied(), !side);
+    info.known |= checkers_known | pins_known;
+    info.hv_pinmask = xray_rook_attacks(occupied(), own_pieces, king_location) & (pieces[black_rook + !side] | pieces[black_queen + !side]);
+    info.dd_pinmask = xray_bishop_attacks(occupied(), own_pieces, king_location) & (pieces[black_bishop + !side] | pieces[black_queen + !side]);
+    u64 pinners = info.hv_pinmask;
+    while (pinners) info.hv_pinmask |= between[pop_lsb(pinners)][king_location];
+    pinners = info.dd_pinmask;
+    while (pinners) info.dd_pinmask |= between[pop_lsb(pinners)][king_location];
+    const u64 bishop_checks = bishop_attacks(occupied(), enemy_king);
+    const u64 rook_checks = rook_attacks(occupied(), enemy_king);
+    info.check_squares[0] = pawn_attacks[!side][enemy_king];
+    info.check_squares[1] = knight_attacks[enemy_king];
+    info.check_squares[2] = bishop_checks;
+    info.check_squares[3] = rook_checks;
+    info.check_squares[4] = bishop_checks | rook_checks;
+    info.check_squares[5] = 0;
+    info.discoverers = 0;
+    u64 snipers = (xray_rook_attacks(occupied(), own_pieces, enemy_king) & (pieces[black_rook + side] | pieces[black_queen + side]))
+        | (xray_bishop_attacks(occupied(), own_pieces, enemy_king) & (pieces[black_bishop + side] | pieces[black_queen + side]));
+    while (snipers) info.discoverers |= between[pop_lsb(snipers)][enemy_king] & own_pieces;
+}
+
+//no sequence of legal moves can mate: bare kings, a single knight, or bishops that all stand on one colour
+bool Position::insufficient_material() {
+    constexpr u64 light_squares = 0xaa55aa55aa55aa55;
+    if (pieces[black_pawn] | pieces[white_pawn] | pieces[black_rook] | pieces[white_rook] | pieces[black_queen] | pieces[white_queen]) return false;
+    const u64 knights = pieces[black_knight] | pieces[white_knight];
+    const u64 bishops = pieces[black_bishop] | pieces[white_bishop];
+    if (!bishops) return !(knights & (knights - 1));
+    return !knights && (!(bishops & light_squares) || !(bishops & ~light_squares));
+}
+
+//every reversible move of a piece on the empty board by the key difference it makes, in a two-way cuckoo hash of 8192 slots
+struct Cuckoo {
+    std::array<u64, 8192> keys{};
+    std::array<Move, 8192> moves{};
+    int count{};
+};
+
+static int cuckoo_h1(u64 key) {return key & 0x1fff;}
+static int cuckoo_h2(u64 key) {return (key >> 16) & 0x1fff;}
+
+//built from the constexpr tables and the zobrist keys, both of which are initialized before any code runs
+static Cuckoo make_cuckoo() {
+    Cuckoo table;
+    for (int piece{black_knight}; piece <= white_king; ++piece) {
+        for (int square1{}; square1 < 64; ++square1) {
+            u64 attacks{};
+            const int type = piece >> 1;
+            if (type == 1) attacks = knight_attacks[square1];
+            else if (type == 5) attacks = king_attacks[square1];
+            for (int direction{}; direction < 8; ++direction) {
+                const bool diagonal = direction_steps[direction][0] && direction_steps[direction][1];
+                if ((type == 2 && diagonal) || (type == 3 && !diagonal) || type == 4) attacks |= rays[direction][square1];
+            }
+            for (int square2{square1 + 1}; square2 < 64; ++square2) {
+                if (!(attacks & (1ull << square2))) continue;
+                Move move{square1, square2};
+                u64 key = zobrist_pieces[piece][square1] ^ zobrist_pieces[piece][square2] ^ zobrist_black;
+                int slot = cuckoo_h1(key);
+                while (true) { //the displaced entry moves to its other slot
+                    std::swap(table.keys[slot], key);
+                    std::swap(table.moves[slot], move);
+                    if (move.is_null()) break;
+                    slot = slot == cuckoo_h1(key) ? cuckoo_h2(key) : cuckoo_h1(key);
+                }
+                ++table.count;
+            }
+        }
+    }
+    return table;
+}
+
+static const Cuckoo cuckoo = make_cuckoo();
+
+int cuckoo_count() {
+    return cuckoo.count;
+}
+
+//whether the side to move has a reversible move back to a position of the last halfmove_clock plies, found from the key difference without generating moves,
+//inside the search either side getting there is a draw, before the root it has to be a move of the side to move, counted from search ply 3 like draw()
+bool Position::upcoming_repetition(int search_ply) {
+    const int end = std::min(static_cast<int>(states[ply].halfmove_clock), ply);
+    if (end < 3) return false;
+    const u64 key = states[ply].key;
+    for (int i{3}; i <= end; i += 2) {
+        const u64 move_key = key ^ states[ply - i].key;
+        int slot = cuckoo_h1(move_key);
+        if (cuckoo.keys[slot] != move_key) slot = cuckoo_h2(move_key);
+        if (cuckoo.keys[slot] != move_key) continue;
+        const Move move = cuckoo.moves[slot];
+        if (between[move.start()][move.end()] & occupied()) continue;
+        if (i < search_ply) return true;
+        const int piece = board[move.start()] == empty_square ? board[move.end()] : board[move.start()];
+        if (search_ply > 2 && (piece & 1) == side_to_move) return true;
+    }
+    return false;
 }
 
 bool Position::draw(int num_reps) {
-    if (halfmove_clock[ply] < 8) return false;
-    if (halfmove_clock[ply] >= 100) return true;
-    u64 curr_hash = hash[ply];
+    const int halfmove_clock = states[ply].halfmove_clock;
+    if (halfmove_clock < 8) return false;
+    if (halfmove_clock >= 100) return true;
+    u64 curr_hash = states[ply].key;
     int repeats{};
-    for (int i{ply - 4}; i >= 0 && i >= ply - halfmove_clock[ply] && repeats < num_reps; i -= 2) repeats += (hash[i] == curr_hash);
+    for (int i{ply - 4}; i >= 0 && i >= ply - halfmove_clock && repeats < num_reps; i -= 2) repeats += (states[i].key == curr_hash);
     return (repeats >= num_reps);
 }
 
+//en passant can expose the king along the rank of both pawns, so it is checked by making it on the occupancy
+bool Position::enpassant_legal(int start, int end) {
+    const bool side = side_to_move;
+    const int king_location = get_lsb(pieces[black_king + side]);
+    const u64 occ = occupied() ^ (1ull << start) ^ (1ull << end) ^ (1ull << (end ^ 8));
+    return !(bishop_attacks(occ, king_location) & (pieces[black_bishop + !side] | pieces[black_queen + !side]))
+        && !(rook_attacks(occ, king_location) & (pieces[black_rook + !side] | pieces[black_queen + !side]))
+        && !(knight_attacks[king_location] & pieces[black_knight + !side])
+        && !(pawn_attacks[side][king_location] & pieces[black_pawn + !side] & ~(1ull << (end ^ 8)));
+}
+
+//moves of the pieces that are not pinned, restricted to targets, shared by the normal and the evasion generator
+template <Move_types types, bool side> void Position::generate_unpinned(Movelist& movelist, u64 targets, u64 not_pinned) {
+    constexpr bool gen_quiet = types & 1;
+    constexpr bool gen_noisy = types & 2;
+    const u64 opp_pieces = colors[!side];
+    const u64 promote_mask{promotion_rank<side>()};
+    u64 curr_board, curr_moves;
+    int piece_location;
+    int end;
+
+    curr_board = pieces[side] & ~promote_mask & not_pinned;//non-pinned non-promoting pawns
+    while (curr_board != 0) {
+        piece_location = pop_lsb(curr_board);
+        curr_moves = 0;
+        if constexpr (gen_noisy) curr_moves = pawn_attacks[side][piece_location] & opp_pieces;
+        if constexpr (gen_quiet) curr_moves |= forward_attacks<side>(occupied(), piece_location) & pawn_pushes[side][piece_location] & ~occupied();
+        curr_moves &= targets;
+        movelist.add_targets(piece_location, curr_moves);
+    }
+    curr_board = pieces[side] & promote_mask & not_pinned;//non-pinned promoting pawns
+    while (curr_board != 0) {
+        piece_location = pop_lsb(curr_board);
+        curr_moves = 0;
+        if constexpr (gen_noisy) curr_moves = pawn_attacks[side][piece_location] & opp_pieces;
+        if constexpr (gen_quiet) curr_moves |= pawn_pushes[side][piece_location] & ~occupied();
+        curr_moves &= targets;
+        while (curr_moves != 0) {
+            end = pop_lsb(curr_moves);
+            movelist.add(Move{piece_location, end, knight_pr});
+            movelist.add(Move{piece_location, end, bishop_pr});
+            movelist.add(Move{piece_location, end, rook_pr});
+            movelist.add(Move{piece_location, end, queen_pr});
+        }
+    }
+
+    //non-pinned knights
+    curr_board = pieces[side + 2] & not_pinned;
+    while (curr_board != 0) {
+        piece_location = pop_lsb(curr_board);
+        curr_moves = knight_attacks[piece_location] & targets;
+        movelist.add_targets(piece_location, curr_moves);
+    }
+
+    //non-pinned diagonal sliders
+    curr_board = (pieces[side + 4] | pieces[side + 8]) & not_pinned;
+    while (curr_board != 0) {
+        piece_location = pop_lsb(curr_board);
+        curr_moves = bishop_attacks(occupied(), piece_location) & targets;
+        movelist.add_targets(piece_location, curr_moves);
+    }
+
+    //non-pinned horizontal sliders
+    curr_board = (pieces[side + 6] | pieces[side + 8]) & not_pinned;
+    while (curr_board != 0) {
+        piece_location = pop_lsb(curr_board);
+        curr_moves = rook_attacks(occupied(), piece_location) & targets;
+        movelist.add_targets(piece_location, curr_moves);
+    }
+
+    //en passant, pinned pawns included since the test covers every way it can expose the king
+    if constexpr (gen_noisy) {
+        const int ep_square = states[ply].enpassant_square;
+        curr_board = pawn_attacks[!side][ep_square] & pieces[side];//possible capturing pawns
+        while (curr_board != 0) {
+            piece_location = pop_lsb(curr_board);
+            if (enpassant_legal(piece_location, ep_square)) movelist.add(Move{piece_location, ep_square, enpassant});
+        }
+    }
+}
+
+//only king moves, captures of a single checker and blocks of its ray get out of check, pinned pieces can do neither
+template <Move_types types, bool side> void Position::generate_evasions(Movelist& movelist, u64 targets) {
+    const Check_info& info = check_info();
+    if (info.checkers & (info.checkers - 1)) return;
+    const int checker = get_lsb(info.checkers);
+    generate_unpinned<types, side>(movelist, targets & (between[checker][get_lsb(pieces[black_king + side])] | info.checkers), ~(info.hv_pinmask | info.dd_pinmask));
+}
+
+//every generated move is legal
 template <Move_types types, bool side> void Position::generate_stage_side(Movelist& movelist) {
     assert(popcount(pieces[black_king]) == 1);
     assert(popcount(pieces[white_king]) == 1);
@@ -50,11 +276,10 @@ template <Move_types types, bool side> void Position::generate_stage_side(Moveli
 
     movelist.clear();
 
-    u64 own_pieces{pieces[side] | pieces[side + 2] | pieces[side + 4] | pieces[side + 6] | pieces[side + 8] | pieces[side + 10]};
-    u64 opp_pieces{occupied ^ own_pieces};
+    u64 opp_pieces{colors[!side]};
 
     u64 targets{};
-    if constexpr (gen_quiet) targets |= ~occupied;
+    if constexpr (gen_quiet) targets |= ~occupied();
     if constexpr (gen_noisy) targets |= opp_pieces;
 
     u64 curr_board, curr_moves;
@@ -63,191 +288,92 @@ template <Move_types types, bool side> void Position::generate_stage_side(Moveli
     int king_location = get_lsb(pieces[black_king + side]);
 
     u64 promote_mask{promotion_rank<side>()};
-    int ep_square = enpassant_square[ply];
 
-    u64 hv_pinmask{(xray_rook_attacks(occupied, own_pieces, king_location) & (pieces[black_rook + !side] | pieces[black_queen + !side]))};
-    u64 dd_pinmask{(xray_bishop_attacks(occupied, own_pieces, king_location) & (pieces[black_bishop + !side] | pieces[black_queen + !side]))};
-    curr_board = hv_pinmask;
-    while (curr_board) {
-        piece_location = pop_lsb(curr_board);
-        hv_pinmask |= between[piece_location][king_location];
-    }
-    curr_board = dd_pinmask;
-    while (curr_board) {
-        piece_location = pop_lsb(curr_board);
-        dd_pinmask |= between[piece_location][king_location];
-    }
-    u64 not_pinned{~(hv_pinmask | dd_pinmask)};
+    const Check_info& info = check_info();
+    const u64 hv_pinmask = info.hv_pinmask;
+    const u64 dd_pinmask = info.dd_pinmask;
 
-    u64 curr_checkers{checkers(occupied)};
-
-    //king moves
+    //king moves, the attack map is only built when the king has somewhere to go
     curr_moves = king_attacks[king_location] & targets;
-    while (curr_moves != 0) {
-        end = pop_lsb(curr_moves);
-        movelist.add(Move{board[king_location], king_location, board[end], end, none});
-    }
-
-    switch (popcount(curr_checkers)) {
-        case 2:
-            return; //double check
-        case 1: //single check
-            targets &= between[get_lsb(curr_checkers)][king_location] ^ curr_checkers;
-        case 0: // no check
-            curr_board = pieces[side] & ~promote_mask & not_pinned;//non-pinned non-promoting pawns
-            while (curr_board != 0) {
-                piece_location = pop_lsb(curr_board);
-                if constexpr (gen_noisy) curr_moves = pawn_attacks[side][piece_location] & opp_pieces;
-                if constexpr (gen_quiet) curr_moves |= forward_attacks<side>(occupied, piece_location) & pawn_pushes[side][piece_location] & ~occupied;
-                curr_moves &= targets;
-                while (curr_moves != 0) {
-                    end = pop_lsb(curr_moves);
-                    movelist.add(Move{board[piece_location], piece_location, board[end], end, none});
-                }
-            }
-            curr_board = pieces[side] & promote_mask & not_pinned;//non-pinned promoting pawns
-            while (curr_board != 0) {
-                piece_location = pop_lsb(curr_board);
-                if constexpr (gen_noisy) curr_moves = pawn_attacks[side][piece_location] & opp_pieces;
-                if constexpr (gen_quiet) curr_moves |= pawn_pushes[side][piece_location] & ~occupied;
-                curr_moves &= targets;
-                while (curr_moves != 0) {
-                    end = pop_lsb(curr_moves);
-                    movelist.add(Move{board[piece_location], piece_location, board[end], end, knight_pr});
-                    movelist.add(Move{board[piece_location], piece_location, board[end], end, bishop_pr});
-                    movelist.add(Move{board[piece_location], piece_location, board[end], end, rook_pr});
-                    movelist.add(Move{board[piece_location], piece_location, board[end], end, queen_pr});
-                }
-            }
-
-            //non-pinned knights
-            curr_board = pieces[side + 2] & not_pinned;
-            while (curr_board != 0) {
-                piece_location = pop_lsb(curr_board);
-                curr_moves = knight_attacks[piece_location] & targets;
-                while (curr_moves != 0) {
-                    end = pop_lsb(curr_moves);
-                    movelist.add(Move{board[piece_location], piece_location, board[end], end, none});
-                }
-            }
+    if (curr_moves) curr_moves &= ~king_danger();
+    movelist.add_targets(king_location, curr_moves);
 
-            //non-pinned diagonal sliders
-            curr_board = (pieces[side + 4] | pieces[side + 8]) & not_pinned;
-            while (curr_board != 0) {
-                piece_location = pop_lsb(curr_board);
-                curr_moves = bishop_attacks(occupied, piece_location) & targets;
-                while (curr_moves != 0) {
-                    end = pop_lsb(curr_moves);
-                    movelist.add(Move{board[piece_location], piece_location, board[end], end, none});
-                }
-            }
+    if (info.checkers) return generate_evasions<types, side>(movelist, targets);
 
-            //non-pinned horizontal sliders
-            curr_board = (pieces[side + 6] | pieces[side + 8]) & not_pinned;
-            while (curr_board != 0) {
-                piece_location = pop_lsb(curr_board);
-                curr_moves = rook_attacks(occupied, piece_location) & targets;
-                while (curr_moves != 0) {
-                    end = pop_lsb(curr_moves);
-                    movelist.add(Move{board[piece_location], piece_location, board[end], end, none});
-                }
-            }
+    generate_unpinned<types, side>(movelist, targets, ~(hv_pinmask | dd_pinmask));
 
-            //en passant
-            if constexpr (gen_noisy) {
-                curr_board = pawn_attacks[!side][ep_square] & pieces[side];//possible capturing pawns
-                while (curr_board != 0) {
-                    piece_location = pop_lsb(curr_board);
-                    movelist.add(Move{board[piece_location], piece_location, 12, ep_square, enpassant});
-                }
-            }
-            if (popcount(curr_checkers)) return; //if we are in check don't generate moves of pinned pieces and castling
-
-            //pinned non-promoting pawns
-            if constexpr (gen_quiet) {
-                curr_board = pieces[side] & ~promote_mask & hv_pinmask;
-                while (curr_board != 0) {
-                    piece_location = pop_lsb(curr_board);
-                    curr_moves |= forward_attacks<side>(occupied, piece_location) & pawn_pushes[side][piece_location] & (~occupied) & hv_pinmask;
-                    while (curr_moves != 0) {
-                        end = pop_lsb(curr_moves);
-                        movelist.add(Move{board[piece_location], piece_location, board[end], end, none});
-                    }
-                }
-            }
-            if constexpr (gen_noisy) {
-                curr_board = pieces[side] & ~promote_mask & dd_pinmask;
-                while (curr_board != 0) {
-                    piece_location = pop_lsb(curr_board);
-                    curr_moves = pawn_attacks[side][piece_location] & opp_pieces & dd_pinmask;
-                    while (curr_moves != 0) {
-                        end = pop_lsb(curr_moves);
-                        movelist.add(Move{board[piece_location], piece_location, board[end], end, none});
-                    }
-                }
-            }
+    //pinned non-promoting pawns
+    if constexpr (gen_quiet) {
+        curr_board = pieces[side] & ~promote_mask & hv_pinmask;
+        while (curr_board != 0) {
+            piece_location = pop_lsb(curr_board);
+            curr_moves = forward_attacks<side>(occupied(), piece_location) & pawn_pushes[side][piece_location] & (~occupied()) & hv_pinmask;
+            movelist.add_targets(piece_location, curr_moves);
+        }
+    }
+    if constexpr (gen_noisy) {
+        curr_board = pieces[side] & ~promote_mask & dd_pinmask;
+        while (curr_board != 0) {
+            piece_location = pop_lsb(curr_board);
+            curr_moves = pawn_attacks[side][piece_location] & opp_pieces & dd_pinmask;
+            movelist.add_targets(piece_location, curr_moves);
+        }
+    }
 
-            //pinned promoting pawns
-            curr_board = pieces[side] & promote_mask & dd_pinmask;
-            //note: hv-pinned pawns on 7th rank cannot push (or capture) in either case
-            if constexpr (gen_noisy) {
-                while (curr_board != 0) {
-                    piece_location = pop_lsb(curr_board);
-                    curr_moves = pawn_attacks[side][piece_location] & opp_pieces & dd_pinmask;
-                    while (curr_moves != 0) {
-                        end = pop_lsb(curr_moves);
-                        movelist.add(Move{board[piece_location], piece_location, board[end], end, knight_pr});
-                        movelist.add(Move{board[piece_location], piece_location, board[end], end, bishop_pr});
-                        movelist.add(Move{board[piece_location], piece_location, board[end], end, rook_pr});
-                        movelist.add(Move{board[piece_location], piece_location, board[end], end, queen_pr});
-                    }
-                }
+    //pinned promoting pawns
+    curr_board = pieces[side] & promote_mask & dd_pinmask;
+    //note: hv-pinned pawns on 7th rank cannot push (or capture) in either case
+    if constexpr (gen_noisy) {
+        while (curr_board != 0) {
+            piece_location = pop_lsb(curr_board);
+            curr_moves = pawn_attacks[side][piece_location] & opp_pieces & dd_pinmask;
+            while (curr_moves != 0) {
+                end = pop_lsb(curr_moves);
+                movelist.add(Move{piece_location, end, knight_pr});
+                movelist.add(Move{piece_location, end, bishop_pr});
+                movelist.add(Move{piece_location, end, rook_pr});
+                movelist.add(Move{piece_location, end, queen_pr});
             }
+        }
+    }
 
-            //note: pinned knights cannot move
+    //note: pinned knights cannot move
 
-            //pinned diagonal sliders
-            curr_board = (pieces[side + 4] | pieces[side + 8]) & dd_pinmask;
-            while (curr_board != 0) {
-                piece_location = pop_lsb(curr_board);
-                curr_moves = bishop_attacks(occupied, piece_location) & targets & dd_pinmask;
-                while (curr_moves != 0) {
-                    end = pop_lsb(curr_moves);
-                    movelist.add(Move{board[piece_location], piece_location, board[end], end, none});
-                }
-            }
+    //pinned diagonal sliders
+    curr_board = (pieces[side + 4] | pieces[side + 8]) & dd_pinmask;
+    while (curr_board != 0) {
+        piece_location = pop_lsb(curr_board);
+        curr_moves = bishop_attacks(occupied(), piece_location) & targets & dd_pinmask;
+        movelist.add_targets(piece_location, curr_moves);
+    }
 
-            //pinned horizontal sliders
-            curr_board = (pieces[side + 6] | pieces[side + 8]) & hv_pinmask;
-            while (curr_board != 0) {
-                piece_location = pop_lsb(curr_board);
-                curr_moves = rook_attacks(occupied, piece_location) & targets & hv_pinmask;
-                while (curr_moves != 0) {
-                    end = pop_lsb(curr_moves);
-                    movelist.add(Move{board[piece_location], piece_location, board[end], end, none});
-                }
-            }
+    //pinned horizontal sliders
+    curr_board = (pieces[side + 6] | pieces[side + 8]) & hv_pinmask;
+    while (curr_board != 0) {
+        piece_location = pop_lsb(curr_board);
+        curr_moves = rook_attacks(occupied(), piece_location) & targets & hv_pinmask;
+        movelist.add_targets(piece_location, curr_moves);
+    }
 
-            if constexpr (gen_quiet) { //castling
-                bool king_castle, queen_castle;
-                int shift;
-                if constexpr (side) {
-                    king_castle = castling_rights[ply][3] != 64;
-                    queen_castle = castling_rights[ply][2] != 64;
-                    shift = 56;
-                } else {
-                    king_castle = castling_rights[ply][1] != 64;
-                    queen_castle = castling_rights[ply][0] != 64;
-                    shift = 0;
-                }
-                if (king_castle && !((occupied >> shift) & 0x60ull)) { //kingside
-                    movelist.add(Move{black_king + side, king_location, empty_square, castling_rights[ply][side * 2 + 1], k_castling});
-                }
-                if (queen_castle && !((occupied >> shift) & 0xeull)) { //queenside
-                    movelist.add(Move{black_king + side, king_location, empty_square, castling_rights[ply][side * 2], q_castling});
-                }
-            }
-            return;
+    if constexpr (gen_quiet) { //castling, the squares the king crosses must be empty and unattacked
+        bool king_castle, queen_castle;
+        int shift;
+        const int rights = states[ply].castling_rights;
+        if constexpr (side) {
+            king_castle = rights & 8;
+            queen_castle = rights & 4;
+            shift = 56;
+        } else {
+            king_castle = rights & 2;
+            queen_castle = rights & 1;
+            shift = 0;
+        }
+        if (king_castle && !((occupied() >> shift) & 0x60ull) && !((king_danger() >> shift) & 0x60ull)) { //kingside
+            movelist.add(Move{king_location, castling_rooks[side * 2 + 1], k_castling});
+        }
+        if (queen_castle && !((occupied() >> shift) & 0xeull) && !((king_danger() >> shift) & 0xcull)) { //queenside
+            movelist.add(Move{king_location, castling_rooks[side * 2], q_castling});
+        }
     }
 }
 
@@ -262,11 +388,13 @@ template void Position::generate_stage<all>(Movelist& movelist);
 
 template <bool update_nnue, bool update_hash> void Position::remove_piece(int sq) {
     if constexpr (update_hash) {
-        hash[ply] ^= zobrist_pieces[board[sq]][sq];
+        states[ply].key ^= zobrist_pieces[board[sq]][sq];
+        states[ply].material_key ^= zobrist_pieces[board[sq]][popcount(pieces[board[sq]]) - 1];
     }
     if constexpr (update_nnue) {
-        if (board[sq] != empty_square) nnue_sub.push_back({index(board[sq], sq, 0, king_square[0]), index(board[sq], sq, 1, king_square[1])});
+        if (board[sq] != empty_square) dirty_pieces->sub(board[sq], sq);
     }
+    if (board[sq] != empty_square) colors[board[sq] & 1] ^= (1ull << sq);
     pieces[board[sq]] ^= (1ull << sq);
     pieces[12] ^= (1ull << sq);
     board[sq] = 12;
@@ -274,11 +402,13 @@ template <bool update_nnue, bool update_hash> void Position::remove_piece(int sq
 
 template <bool update_nnue, bool update_hash> void Position::add_piece(int sq, int piece) {
     if constexpr (update_hash) {
-        hash[ply] ^= zobrist_pieces[piece][sq];
+        states[ply].key ^= zobrist_pieces[piece][sq];
+        states[ply].material_key ^= zobrist_pieces[piece][popcount(pieces[piece])];
     }
     if constexpr (update_nnue) {
-        if (piece != empty_square) nnue_add.push_back({index(piece, sq, 0, king_square[0]), index(piece, sq, 1, king_square[1])});
+        if (piece != empty_square) dirty_pieces->add(piece, sq);
     }
+    if (piece != empty_square) colors[piece & 1] ^= (1ull << sq);
     pieces[12] ^= (1ull << sq);
     pieces[piece] ^= (1ull << sq);
     board[sq] = piece;
@@ -286,27 +416,48 @@ template <bool update_nnue, bool update_hash> void Position::add_piece(int sq, i
 
 template <bool update_nnue, bool update_hash> void Position::remove_add_piece(int sq, int piece) {
     if constexpr (update_hash) {
-        hash[ply] ^= zobrist_pieces[board[sq]][sq] ^ zobrist_pieces[piece][sq];
+        states[ply].key ^= zobrist_pieces[board[sq]][sq] ^ zobrist_pieces[piece][sq];
+        //the empty square's row is zero, so a move to an empty square leaves the material alone
+        states[ply].material_key ^= zobrist_pieces[board[sq]][popcount(pieces[board[sq]]) - 1] ^ zobrist_pieces[piece][popcount(pieces[piece])];
     }
     if constexpr (update_nnue) {
-        if (board[sq] != empty_square) nnue_sub.push_back({index(board[sq], sq, 0, king_square[0]), index(board[sq], sq, 1, king_square[1])});
-        if (piece != empty_square) nnue_add.push_back({index(piece, sq, 0, king_square[0]), index(piece, sq, 1, king_square[1])});
+        if (board[sq] != empty_square) dirty_pieces->sub(board[sq], sq);
+        if (piece != empty_square) dirty_pieces->add(piece, sq);
     }
+    if (board[sq] != empty_square) colors[board[sq] & 1] ^= (1ull << sq);
+    if (piece != empty_square) colors[piece & 1] ^= (1ull << sq);
     pieces[board[sq]] ^= (1ull << sq);
     pieces[piece] ^= (1ull << sq);
     board[sq] = piece;
 }
 
+//clears the castling rights a move from or to a square ends
+constexpr int castling_masks[64] {
+    14, 15, 15, 15, 12, 15, 15, 13,
+    15, 15, 15, 15, 15, 15, 15, 15,
+    15, 15, 15, 15, 15, 15, 15, 15,
+    15, 15, 15, 15, 15, 15, 15, 15,
+    15, 15, 15, 15, 15, 15, 15, 15,
+    15, 15, 15, 15, 15, 15, 15, 15,
+    15, 15, 15, 15, 15, 15, 15, 15,
+    11, 15, 15, 15,  3, 15, 15,  7
+};
+
 template <bool update_nnue> void Position::make_move(Move move, NNUE* nnue) {
-    if constexpr (update_nnue) {
-        assert(nnue_sub.empty());
-        nnue->push();
+    if constexpr (update_nnue) dirty_pieces = &nnue->push();
+    if (++ply == static_cast<int>(states.size())) {
+        states.emplace_back();
+        check_infos.emplace_back();
     }
-    ++ply;
+    check_infos[ply].known = 0;
+    const State_info& previous = states[ply - 1];
+    State_info& state = states[ply];
+    state.key = previous.key ^ zobrist_black;
+    state.material_key = previous.material_key;
     int start = move.start();
     int end = move.end();
-    int piece = move.piece();
-    int captured = move.captured();
+    int piece = board[start];
+    int captured = captured_piece(move);
     int king_end = end;
     switch (move.flag()) {
         case none:
@@ -349,31 +500,18 @@ template <bool update_nnue> void Position::make_move(Move move, NNUE* nnue) {
             add_piece<update_nnue, true>(end, piece);
             break;
     }
-    enpassant_square[ply] = (!(piece & ~1) && end == (start ^ 16)) ? (end ^ 8) : 64;
-    memcpy(castling_rights[ply], castling_rights[ply - 1], sizeof(int) * 4);
-    if (castling_rights[ply][0] != 64 && board[castling_rights[ply][0]] != black_rook) castling_rights[ply][0] = 64;
-    if (castling_rights[ply][1] != 64 && board[castling_rights[ply][1]] != black_rook) castling_rights[ply][1] = 64;
-    if (castling_rights[ply][2] != 64 && board[castling_rights[ply][2]] != white_rook) castling_rights[ply][2] = 64;
-    if (castling_rights[ply][3] != 64 && board[castling_rights[ply][3]] != white_rook) castling_rights[ply][3] = 64;
-    if (piece == black_king) {
-        castling_rights[ply][0] = 64;
-        castling_rights[ply][1] = 64;
-    }
-    if (piece == white_king) {
-        castling_rights[ply][2] = 64;
-        castling_rights[ply][3] = 64;
-    }
-    halfmove_clock[ply] = ((!(piece & ~1) || captured != 12) ? 0 : halfmove_clock[ply - 1] + 1);
-    for (int i{}; i<4; ++i) {
-        hash[ply] ^= zobrist_castling[castling_rights[ply - 1][i]] ^ zobrist_castling[castling_rights[ply][i]];
-    }
-    hash[ply] ^= zobrist_enpassant[enpassant_square[ply - 1]] ^ zobrist_enpassant[enpassant_square[ply]];
-    nnue_refresh = 0;
-    if constexpr (update_nnue) if (piece == black_king + side_to_move && (((start ^ king_end) & 4) || (buckets > 1 && king_buckets[start ^ (56 * side_to_move)] != king_buckets[king_end ^ (56 * side_to_move)]))) {
-        nnue_refresh = 1 + side_to_move;
+    state.enpassant_square = (!(piece & ~1) && end == (start ^ 16)) ? (end ^ 8) : 64;
+    state.castling_rights = previous.castling_rights & castling_masks[start] & castling_masks[end];
+    state.halfmove_clock = ((!(piece & ~1) || captured != 12) ? 0 : previous.halfmove_clock + 1);
+    state.captured = captured;
+    if (state.castling_rights != previous.castling_rights) state.key ^= castling_key(previous.castling_rights ^ state.castling_rights);
+    state.key ^= zobrist_enpassant[previous.enpassant_square] ^ zobrist_enpassant[state.enpassant_square];
+    if (piece == black_king + side_to_move) {
+        if constexpr (update_nnue) if (((start ^ king_end) & 4) || (buckets > 1 && king_buckets[start ^ (56 * side_to_move)] != king_buckets[king_end ^ (56 * side_to_move)])) {
+            dirty_pieces->refresh = 1 + side_to_move;
+        }
+        king_square[side_to_move] = king_end;
     }
-    king_square[0] = get_lsb(pieces[10]);
-    king_square[1] = get_lsb(pieces[11]);
     side_to_move = !side_to_move;
 }
 
@@ -385,98 +523,226 @@ template <bool update_nnue> void Position::undo_move(Move move, NNUE* nnue) {
     side_to_move = !side_to_move;
     int start = move.start();
     int end = move.end();
-    int piece = move.piece();
-    int captured = move.captured();
+    int piece = moved_piece_after(move);
+    int captured = states[ply].captured;
     switch (move.flag()) {
         case none:
-            add_piece<update_nnue, false>(start, piece);
-            remove_add_piece<update_nnue, false>(end, captured);
+            add_piece<false, false>(start, piece);
+            remove_add_piece<false, false>(end, captured);
             break;
         case knight_pr:
         case bishop_pr:
         case rook_pr:
         case queen_pr:
-            add_piece<update_nnue, false>(start, piece);
-            remove_add_piece<update_nnue, false>(end, captured);
+            add_piece<false, false>(start, piece);
+            remove_add_piece<false, false>(end, captured);
             break;
         case k_castling:
-            remove_piece<update_nnue, false>((start & 56) + 6);
-            remove_piece<update_nnue, false>((start & 56) + 5);
-            add_piece<update_nnue, false>(start, piece);
-            add_piece<update_nnue, false>(end, piece - 4);
+            remove_piece<false, false>((start & 56) + 6);
+            remove_piece<false, false>((start & 56) + 5);
+            add_piece<false, false>(start, piece);
+            add_piece<false, false>(end, piece - 4);
             break;
         case q_castling:
-            remove_piece<update_nnue, false>((start & 56) + 2);
-            remove_piece<update_nnue, false>((start & 56) + 3);
-            add_piece<update_nnue, false>(start, piece);
-            add_piece<update_nnue, false>(end, piece - 4);
+            remove_piece<false, false>((start & 56) + 2);
+            remove_piece<false, false>((start & 56) + 3);
+            add_piece<false, false>(start, piece);
+            add_piece<false, false>(end, piece - 4);
             break;
         case enpassant:
-            add_piece<update_nnue, false>(start, piece);
-            remove_piece<update_nnue, false>(end);
-            add_piece<update_nnue, false>(end ^ 8, piece ^ 1);
+            add_piece<false, false>(start, piece);
+            remove_piece<false, false>(end);
+            add_piece<false, false>(end ^ 8, piece ^ 1);
             break;
     }
-    king_square[0] = get_lsb(pieces[10]);
-    king_square[1] = get_lsb(pieces[11]);
-    nnue_sub.clear();
-    nnue_add.clear();
+    //only the mover's king can have moved, and it goes back to where the move started
+    if (piece == black_king + side_to_move) king_square[side_to_move] = start;
     --ply;
 }
 
 template void Position::undo_move<false>(Move move, NNUE* nnue);
 template void Position::undo_move<true>(Move move, NNUE* nnue);
 
+//saves the board whole so that undo is a copy back instead of replaying the move in reverse
+template <bool update_nnue> void Position::make_move_copy(Move move, NNUE* nnue) {
+    if (ply == static_cast<int>(copies.size())) copies.emplace_back();
+    Board_copy& copy = copies[ply];
+    std::memcpy(copy.pieces, pieces, sizeof(pieces));
+    std::memcpy(copy.colors, colors, sizeof(colors));
+    std::memcpy(copy.board, board, sizeof(board));
+    copy.king_square[0] = king_square[0];
+    copy.king_square[1] = king_square[1];
+    copy.side_to_move = side_to_move;
+    make_move<update_nnue>(move, nnue);
+}
+
+template void Position::make_move_copy<false>(Move move, NNUE* nnue);
+template void Position::make_move_copy<true>(Move move, NNUE* nnue);
+
+template <bool update_nnue> void Position::undo_move_copy(NNUE* nnue) {
+    if constexpr (update_nnue) nnue->pop();
+    const Board_copy& copy = copies[--ply];
+    std::memcpy(pieces, copy.pieces, sizeof(pieces));
+    std::memcpy(colors, copy.colors, sizeof(colors));
+    std::memcpy(board, copy.board, sizeof(board));
+    king_square[0] = copy.king_square[0];
+    king_square[1] = copy.king_square[1];
+    side_to_move = copy.side_to_move;
+}
+
+template void Position::undo_move_copy<false>(NNUE* nnue);
+template void Position::undo_move_copy<true>(NNUE* nnue);
+
+//whether a move could be played here by the rules of its piece, ignoring the safety of the king, for moves that were not generated in this position
+bool Position::is_pseudo_legal(Move move) {
+    const bool side = side_to_move;
+    const int start = move.start();
+    const int end = move.end();
+    const int flag = move.flag();
+    const int piece = board[start];
+    const u64 end_bit = 1ull << end;
+    if (piece == empty_square || (piece & 1) != side) return false;
+    if (flag == k_castling || flag == q_castling) { //the rights imply the king and rook are still on their squares
+        const int index = side * 2 + (flag == k_castling);
+        const int shift = side ? 56 : 0;
+        return piece == black_king + side && end == castling_rooks[index] && (states[ply].castling_rights & (1 << index))
+            && !((occupied() >> shift) & (flag == k_castling ? 0x60ull : 0xeull));
+    }
+    if (colors[side] & end_bit) return false;
+    if (piece == black_pawn + side) {
+        const bool promotion = flag >= knight_pr && flag <= queen_pr;
+        if (flag == enpassant) return end == states[ply].enpassant_square && (pawn_attacks[side][start] & end_bit);
+        if (flag != none && !promotion) return false;
+        if (promotion != static_cast<bool>(end_bit & (side ? 0x00000000000000ffull : 0xff00000000000000ull))) return false;
+        if (pawn_attacks[side][start] & colors[!side] & end_bit) return true;
+        return (pawn_pushes[side][start] & end_bit) && !((between[start][end] | end_bit) & occupied()); //a double push crosses one square
+    }
+    if (flag != none) return false;
+    switch (piece >> 1) {
+        case 1: return knight_attacks[start] & end_bit;
+        case 2: return bishop_attacks(occupied(), start) & end_bit;
+        case 3: return rook_attacks(occupied(), start) & end_bit;
+        case 4: return queen_attacks(occupied(), start) & end_bit;
+        default: return king_attacks[start] & end_bit;
+    }
+}
+
+//the generator only emits legal moves, this is for moves from elsewhere that is_pseudo_legal has accepted
 bool Position::is_legal(Move move) {
+    const Check_info& info = check_info();
+    const int start = move.start();
+    const int end = move.end();
     if (move.flag() == k_castling) {
-        return !attacks_to((move.start() & 56) + 5, occupied, !side_to_move) && !attacks_to((move.start() & 56) + 6, occupied, !side_to_move);
+        return !info.checkers && !(king_danger() & (3ull << ((start & 56) + 5)));
     }
     if (move.flag() == q_castling) {
-        return !attacks_to((move.start() & 56) + 2, occupied, !side_to_move) && !attacks_to((move.start() & 56) + 3, occupied, !side_to_move);
+        return !info.checkers && !(king_danger() & (3ull << ((start & 56) + 2)));
     }
 
     //king moves
-    if ((move.piece() >> 1) == 5) {
-        return !attacks_to(move.end(), occupied ^ (1ull << move.start()), !side_to_move);
+    if ((board[start] >> 1) == 5) {
+        return !(king_danger() & (1ull << end));
     }
 
     if (move.flag() == enpassant) {
-        return !attacks_to(get_lsb(pieces[black_king + side_to_move]), occupied ^ (1ull << move.start()) ^ (1ull << move.end()) ^ (1ull << (move.end() ^ 8)), !side_to_move);
+        return enpassant_legal(start, end);
+    }
+
+    //a single check has to be captured or blocked, a double check leaves only king moves
+    const int king_location = get_lsb(pieces[black_king + side_to_move]);
+    if (info.checkers) {
+        if (info.checkers & (info.checkers - 1)) return false;
+        if (!((between[get_lsb(info.checkers)][king_location] | info.checkers) & (1ull << end))) return false;
     }
 
+    //a pinned piece stays on the line between its king and its pinner
+    if ((info.hv_pinmask | info.dd_pinmask) & (1ull << start)) {
+        return (between[king_location][end] & (1ull << start)) || (between[king_location][start] & (1ull << end));
+    }
     return true;
 }
 
-void Position::nnue_update_accumulator(NNUE& nnue) {
-    if (nnue_refresh) nnue.refresh_side(nnue_refresh - 1, *this);
-    if (nnue_sub.empty()) return;
-    if (nnue_sub.size() > nnue_add.size()) {
-        nnue.update_accumulator_sub_sub_add(3 - nnue_refresh, nnue_sub[0], nnue_sub[1], nnue_add[0]);
-        nnue_sub.pop_back();
-        nnue_sub.pop_back();
-        nnue_add.pop_back();
-        return;
+//whether a legal move checks the opponent, answered from the check squares and discoverers of this ply without making it
+bool Position::gives_check(Move move) {
+    const Check_info& info = check_info();
+    const bool side = side_to_move;
+    const int start = move.start();
+    const int end = move.end();
+    const int flag = move.flag();
+    const int king_location = get_lsb(pieces[black_king + !side]);
+    if (flag == k_castling || flag == q_castling) { //only the rook can check, along the rank or the file it lands on
+        const int king_end = (start & 56) + (flag == k_castling ? 6 : 2);
+        const int rook_end = (start & 56) + (flag == k_castling ? 5 : 3);
+        const u64 occ = (occupied() ^ (1ull << start) ^ (1ull << end)) | (1ull << king_end) | (1ull << rook_end);
+        return rook_attacks(occ, rook_end) & (1ull << king_location);
+    }
+    u64 occ = (occupied() ^ (1ull << start)) | (1ull << end);
+    if (flag >= knight_pr && flag <= queen_pr) { //the promotion flags match the piece types, the pawn leaving may open the line
+        if (flag == knight_pr && (knight_attacks[king_location] & (1ull << end))) return true;
+        if ((flag == bishop_pr || flag == queen_pr) && (bishop_attacks(occ, king_location) & (1ull << end))) return true;
+        if ((flag == rook_pr || flag == queen_pr) && (rook_attacks(occ, king_location) & (1ull << end))) return true;
+    } else if (info.check_squares[board[start] >> 1] & (1ull << end)) return true;
+    if (flag == enpassant) occ ^= 1ull << (end ^ 8); //the captured pawn can uncover a check as well
+    else if (!(info.discoverers & (1ull << start))) return false;
+    const u64 movers = ~(1ull << start);
+    return (bishop_attacks(occ, king_location) & (pieces[black_bishop + side] | pieces[black_queen + side]) & movers)
+        || (rook_attacks(occ, king_location) & (pieces[black_rook + side] | pieces[black_queen + side]) & movers);
+}
+
+//network input features a move will remove or add from one side's view, without making it, at most 4
+int Position::move_features(Move move, bool side, int* features) {
+    const int start = move.start();
+    const int end = move.end();
+    const int piece = board[start];
+    int count{};
+    int king = king_square[side];
+    if (piece == black_king + side && side == side_to_move) {
+        if (move.flag() == k_castling) king = (start & 56) + 6;
+        else if (move.flag() == q_castling) king = (start & 56) + 2;
+        else king = end;
     }
-    while (!nnue_sub.empty()) {
-        nnue.update_accumulator_sub_add(3 - nnue_refresh, nnue_sub.back(), nnue_add.back());
-        nnue_sub.pop_back();
-        nnue_add.pop_back();
+    features[count++] = index(piece, start, side, king);
+    switch (move.flag()) {
+        case k_castling:
+        case q_castling: {
+            const int file = move.flag() == k_castling ? 6 : 2;
+            features[count++] = index(piece - 4, end, side, king);
+            features[count++] = index(piece, (start & 56) + file, side, king);
+            features[count++] = index(piece - 4, (start & 56) + (file == 6 ? 5 : 3), side, king);
+            break;
+        }
+        case enpassant:
+            features[count++] = index(piece ^ 1, end ^ 8, side, king);
+            features[count++] = index(piece, end, side, king);
+            break;
+        default:
+            if (board[end] != empty_square) features[count++] = index(board[end], end, side, king);
+            features[count++] = index(move.flag() == none ? piece : piece + 2 * move.flag(), end, side, king);
     }
+    return count;
 }
 
 int Position::static_eval(NNUE& nnue) {
-    nnue_update_accumulator(nnue);
-    return nnue.evaluate(side_to_move);
+    nnue.update(*this);
+    return scale_endgame(*this, nnue.evaluate(side_to_move));
+}
+
+int Position::small_eval(NNUE& nnue) {
+    nnue.update_small(*this);
+    return scale_endgame(*this, nnue.evaluate_small(side_to_move));
 }
 
 void Position::recalculate_zobrist() {
-    hash[ply] = 0;
-    for (int i{0}; i < 64; ++i) hash[ply] ^= zobrist_pieces[board[i]][i];
-    if (!side_to_move) hash[ply] ^= zobrist_black;
-    for (int i{}; i < 4; ++i) {
-        hash[ply] ^= zobrist_castling[castling_rights[ply][i]];
+    State_info& state = states[ply];
+    state.key = 0;
+    for (int i{0}; i < 64; ++i) state.key ^= zobrist_pieces[board[i]][i];
+    if (!side_to_move) state.key ^= zobrist_black;
+    state.key ^= castling_key(state.castling_rights);
+    state.key ^= zobrist_enpassant[state.enpassant_square];
+    state.material_key = 0;
+    for (int piece{}; piece < empty_square; ++piece) {
+        for (int count{}; count < popcount(pieces[piece]); ++count) state.material_key ^= zobrist_pieces[piece][count];
     }
-    hash[ply] ^= zobrist_enpassant[enpassant_square[ply]];
 }
 
 bool Position::load_fen(std::string fen_pos, std::string fen_stm, std::string fen_castling, std::string fen_ep, std::string fen_hmove_clock, std::string fen_fmove_counter) {
@@ -518,25 +784,33 @@ bool Position::load_fen(std::string fen_pos, std::string fen_stm, std::string fe
     else if (fen_stm == "b") side_to_move = false;
     else return false;
 
-    castling_rights[0][0] = castling_rights[0][1] = castling_rights[0][2] = castling_rights[0][3] = 64;
+    State_info& state = states[0];
+    state.castling_rights = 0;
+    state.captured = empty_square;
     for (auto pos = fen_castling.begin(); pos != fen_castling.end(); ++pos) {
         switch (*pos) {
             case '-': break;
-            case 'q': castling_rights[0][0] = 0; break;
-            case 'k': castling_rights[0][1] = 7; break;
-            case 'Q': castling_rights[0][2] = 56; break;
-            case 'K': castling_rights[0][3] = 63; break;
+            case 'q': state.castling_rights |= 1; break;
+            case 'k': state.castling_rights |= 2; break;
+            case 'Q': state.castling_rights |= 4; break;
+            case 'K': state.castling_rights |= 8; break;
             default: return false;
         }
     }
+    //the masks only clear a right when its king or rook moves, so rights without both on their squares are dropped here
+    for (int i{}; i < 4; ++i) {
+        const bool side = i >> 1;
+        if (board[castling_rooks[i]] != black_rook + side || board[side ? 60 : 4] != black_king + side) state.castling_rights &= ~(1 << i);
+    }
 
-    if (fen_ep == "-") enpassant_square[0] = 64;
-    else if (fen_ep.size() == 2) enpassant_square[0] = (static_cast<int>(fen_ep[0]) - 97) + 8 * (56 - static_cast<int>(fen_ep[1])); //ascii 'a' = 97 '8' = 56
+    if (fen_ep == "-") state.enpassant_square = 64;
+    else if (fen_ep.size() == 2) state.enpassant_square = (static_cast<int>(fen_ep[0]) - 97) + 8 * (56 - static_cast<int>(fen_ep[1])); //ascii 'a' = 97 '8' = 56
     else return false;
 
-    halfmove_clock[0] = stoi(fen_hmove_clock);
+    state.halfmove_clock = std::min(stoi(fen_hmove_clock), 0xffff);
 
     recalculate_zobrist();
+    check_infos[0].known = 0;
     return true;
 }
 
@@ -546,7 +820,6 @@ bool Position::parse_move(Move& out, std::string move) {
     int end = (static_cast<int>(move[2]) - 97) + 8 * (56 - static_cast<int>(move[3]));
     if ((~63 & start) || (~63 & end)) return false; //out-of-bound squares
     int piece = board[start];
-    int captured = board[end];
     int flag{none};
     if (move.size() == 5) {
         switch (move[4]) {
@@ -559,19 +832,16 @@ bool Position::parse_move(Move& out, std::string move) {
         if (piece == black_king + side_to_move && end - start == 2) {
             flag = k_castling;
             end = start + 3;
-            captured = empty_square;
         }
         if (piece == black_king + side_to_move && end - start == -2) {
             flag = q_castling;
             end = start - 4;
-            captured = empty_square;
         }
-        if (piece == black_pawn + side_to_move && (abs(end - start) == 7 || abs(end - start) == 9) && captured == empty_square) {
+        if (piece == black_pawn + side_to_move && (abs(end - start) == 7 || abs(end - start) == 9) && board[end] == empty_square) {
             flag = enpassant;
-            captured = piece ^ 1;
         }
     }
-    out = Move{piece, start, captured, end, flag};
+    out = Move{start, end, flag};
     return true;
 }
 
@@ -1,8 +1,9 @@
 #ifndef EXOCET_BOARD
 #define EXOCET_BOARD
 
-#include "fixed_vector.h"
+#include "kernels.h"
 #include "magics.h"
+#include "movelist.h"
 #include "types.h"
 #include <array>
 #include <string>
@@ -31,10 +32,57 @@ enum Move_types {
 };
 
 class NNUE;
+struct Dirty_pieces;
 
-class Position {
+constexpr int castling_rooks[4] {0, 7, 56, 63}; //rook squares of the castling rights bits, queenside before kingside
+
+//what make_move cannot recover from the move itself, one record per ply
+struct State_info {
+    u64 key;
+    u64 material_key; //the piece counts alone, hashed like the key with the count in place of the square
+    u16 halfmove_clock;
+    u8 enpassant_square; //64 when there is none
+    u8 castling_rights; //bit i is set while the king may castle with the rook on castling_rooks[i]
+    u8 captured;
+};
+
+//everything a move changes outside the ply-indexed history, what copy-make saves before the move and restores on undo
+struct Board_copy {
+    u64 pieces[13];
+    u64 colors[2];
+    u8 board[64];
+    int king_square[2];
+    bool side_to_move;
+};
+
+#ifdef COPY_MAKE
+constexpr bool copy_make = true;
+#else
+constexpr bool copy_make = false;
+#endif
+
+//parts of a Check_info filled in so far, each is computed on first use
+enum Check_info_parts {
+    checkers_known = 1,
+    pins_known = 2, //pins, check squares and discoverers
+    danger_known = 4
+};
+
+//check and pin data of one ply for the side to move, computed at most once per ply and shared by movegen, legality and check detection
+struct Check_info {
+    u64 checkers;
+    u64 hv_pinmask; //rank and file pinners with the squares up to the king, which hold the pinned pieces
+    u64 dd_pinmask; //the same for diagonal pins
+    u64 king_danger; //squares the opponent attacks through the king, where the king cannot go, read through Position::king_danger()
+    u64 check_squares[6]; //squares from which each piece type of the side to move would attack the enemy king
+    u64 discoverers; //pieces of the side to move whose move can uncover a check by one of its sliders
+    int known; //Check_info_parts, cleared by make_move so that perft leaves and stand-pat cutoffs only pay for what they read
+};
+
+//the state movegen and make_move touch comes first and fits in four cache lines
+class alignas(64) Position {
 public:
-    u64 pieces[13] {
+    u64 pieces[13] { //indexed by Piece_types, pieces[empty_square] is the occupancy
         0x000000000000ff00,
         0x00ff000000000000,
         0x0000000000000042,
@@ -49,8 +97,8 @@ public:
         0x1000000000000000,
         0xffff00000000ffff,
     };
-    const u64& occupied{pieces[12]};
-    int board[64] {
+    u64 colors[2] {0x000000000000ffff, 0xffff000000000000}; //occupancy of each side
+    u8 board[64] {
         6,  2,  4,  8, 10,  4,  2,  6,
         0,  0,  0,  0,  0,  0,  0,  0,
         12, 12, 12, 12, 12, 12, 12, 12,
@@ -63,21 +111,54 @@ public:
     int king_square[2] {4, 60};
     bool side_to_move{true};
     int ply{};
-    int enpassant_square[1024]{64};
-    int castling_rights[1024][4]{{0, 7, 56, 63}};
-    int halfmove_clock[1024]{0};
-    u64 hash[1024]{};
-
-    std::vector<std::array<int, 2>> nnue_sub;
-    std::vector<std::array<int, 2>> nnue_add;
-    int nnue_refresh = 0;
+    Dirty_pieces* dirty_pieces = nullptr; //record of the move being made, owned by the NNUE
+    std::vector<State_info> states{{0, 0, 0, 64, 15, empty_square}}; //grows to the longest line played, never shrinks
+    std::vector<Check_info> check_infos{Check_info{}}; //indexed by ply like states, kept apart so that repetition scans stay compact
+    std::vector<Board_copy> copies; //the board before the move of each ply, written only by make_move_copy
 
     Position();
+    inline u64 occupied() const {return pieces[empty_square];}
+    inline State_info& state() {return states[ply];}
+    inline u64 key() {return states[ply].key;}
+    inline u64 material_key() {return states[ply].material_key;}
+    inline const Check_info& check_info() {
+        if (!(check_infos[ply].known & pins_known)) update_check_info();
+        return check_infos[ply];
+    }
+    //forgets what is cached about the current ply's checks and pins, so that they are computed again when next read
+    inline void invalidate_check_info() {check_infos[ply].known = 0;}
+    //the attack map is the costly part and only king moves need it
+    inline u64 king_danger() {
+        Check_info& info = check_infos[ply];
+        if (!(info.known & danger_known)) {
+            const u64 lifted = occupied() ^ pieces[black_king + side_to_move];
+            info.king_danger = side_to_move ? attacked_squares<false>(lifted) : attacked_squares<true>(lifted);
+            info.known |= danger_known;
+        }
+        return info.king_danger;
+    }
+    //castling and en passant take nothing from the end square, en passant's pawn is restored from the moving one
+    inline int captured_piece(Move move) {return move.flag() >= q_castling ? static_cast<int>(empty_square) : static_cast<int>(board[move.end()]);}
+    //the piece a move started with, read back from the board once it has been made and side_to_move is the mover again
+    inline int moved_piece_after(Move move) {
+        const int flag = move.flag();
+        if (flag != none && flag != enpassant) return (flag >= q_castling ? black_king : black_pawn) + side_to_move;
+        return board[move.end()];
+    }
     template <bool side> u64 promotion_rank();
     u64 attacks_to(int square, u64 occ, bool side);
     u64 checkers(u64 occ);
+    template <bool side> u64 attacked_squares(u64 occ);
+    //the attack map of every piece type of a side in one call, sliders looking through the given occupancy
+    inline void attack_maps(bool side, u64 occ, Attack_maps& maps) {kernels->attack_maps(pieces, side, occ, maps);}
+    void update_check_info();
     bool check();
     bool draw(int num_reps = 2);
+    bool upcoming_repetition(int search_ply);
+    bool insufficient_material();
+    bool enpassant_legal(int start, int end);
+    template <Move_types types, bool side> void generate_unpinned(Movelist& movelist, u64 targets, u64 not_pinned);
+    template <Move_types types, bool side> void generate_evasions(Movelist& movelist, u64 targets);
     template <Move_types types, bool side> void generate_stage_side(Movelist& movelist);
     template <Move_types types> void generate_stage(Movelist& movelist);
     template <bool update_nnue, bool update_hash> void remove_piece(int sq);
@@ -85,9 +166,23 @@ public:
     template <bool update_nnue, bool update_hash> void remove_add_piece(int sq, int piece);
     template <bool update_nnue = false> void make_move(Move move, NNUE* nnue = nullptr);
     template <bool update_nnue = false> void undo_move(Move move, NNUE* nnue = nullptr);
+    template <bool update_nnue = false> void make_move_copy(Move move, NNUE* nnue = nullptr);
+    template <bool update_nnue = false> void undo_move_copy(NNUE* nnue = nullptr);
+    //make and undo for search and perft, copy-make when built with COPY_MAKE=yes
+    template <bool update_nnue = false, bool copy = copy_make> inline void play(Move move, NNUE* nnue = nullptr) {
+        if constexpr (copy) make_move_copy<update_nnue>(move, nnue);
+        else make_move<update_nnue>(move, nnue);
+    }
+    template <bool update_nnue = false, bool copy = copy_make> inline void take_back(Move move, NNUE* nnue = nullptr) {
+        if constexpr (copy) undo_move_copy<update_nnue>(nnue);
+        else undo_move<update_nnue>(move, nnue);
+    }
+    bool is_pseudo_legal(Move move);
     bool is_legal(Move move);
-    void nnue_update_accumulator(NNUE& nnue);
+    bool gives_check(Move move);
+    int move_features(Move move, bool side, int* features);
     int static_eval(NNUE& nnue);
+    int small_eval(NNUE& nnue);
     void recalculate_zobrist();
     bool load_fen(std::string fen_pos, std::string fen_stm, std::string fen_castling, std::string fen_ep, std::string fen_hmove_clock, std::string fen_fmove_counter);
     bool parse_move(Move& out, std::string move);
@@ -95,4 +190,7 @@ public:
 
 std::ostream& operator<<(std::ostream& out, Position& position);
 
+//the number of reversible moves in the cuckoo table behind Position::upcoming_repetition, 3668
+int cuckoo_count();
+
 #endif
@@ -0,0 +1,80 @@
+#include "kernels.h"
+
+struct Kernel_entry {
+    const Kernels* table;
+    bool (*supported)();
+};
+
+static bool always_supported() {return true;}
+
+#ifdef KERNEL_DISPATCH
+
+//the levels match the -march flags each kernel copy is built with in the Makefile
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+static bool avx2_supported() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("x86-64-v3");
+}
+
+static bool avx512_supported() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("x86-64-v4");
+}
+
+static bool vnni_supported() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("x86-64-v4") && __builtin_cpu_supports("avx512vnni");
+}
+
+static bool vbmi2_supported() {
+    __builtin_cpu_init();
+    return vnni_supported() && __builtin_cpu_supports("avx512vbmi2");
+}
+#else
+static bool avx2_supported() {return false;}
+static bool avx512_supported() {return false;}
+static bool vnni_supported() {return false;}
+static bool vbmi2_supported() {return false;}
+#endif
+
+//ordered from most to least preferred
+static const Kernel_entry available_kernels[] {
+    {&vbmi2::table, vbmi2_supported},
+    {&vnni::table, vnni_supported},
+    {&avx512::table, avx512_supported},
+    {&avx2::table, avx2_supported},
+    {&generic::table, always_supported},
+};
+
+const Kernels* kernels = &generic::table;
+
+#else
+
+static const Kernel_entry available_kernels[] {
+    {&native::table, always_supported},
+};
+
+const Kernels* kernels = &native::table;
+
+#endif
+
+bool select_kernels(const std::string& name) {
+    for (const Kernel_entry& entry : available_kernels) {
+        if (!entry.supported()) continue;
+        if (name.empty() || name == entry.table->name) {
+            kernels = entry.table;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string supported_kernels() {
+    std::string names;
+    for (const Kernel_entry& entry : available_kernels) {
+        if (!entry.supported()) continue;
+        if (!names.empty()) names += ' ';
+        names += entry.table->name;
+    }
+    return names;
+}
@@ -0,0 +1,91 @@
+#include "endgame.h"
+#include "bits.h"
+#include "lookup.h"
+#include "zobrist.h"
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <initializer_list>
+#include <utility>
+
+//a recognizer adjusts the network's evaluation, from the side to move's point of view, with what it knows of the ending
+using Recognizer = int (*)(Position& position, bool strong_side, int eval);
+
+struct Endgame {
+    u64 material_key;
+    bool strong_side;
+    Recognizer recognize;
+};
+
+constexpr int endgame_slots = 256; //open addressing on the low bits of the material key, most probes find an empty slot
+
+static int center_distance(int square) {
+    const int rank = square >> 3;
+    const int file = square & 7;
+    return std::max(3 - rank, rank - 4) + std::max(3 - file, file - 4);
+}
+
+static int distance(int square1, int square2) {
+    return std::max(std::abs((square1 >> 3) - (square2 >> 3)), std::abs((square1 & 7) - (square2 & 7)));
+}
+
+//a queen or rook mates once the defending king is on the edge with the other king close, the network's evaluation only breaks ties
+static int drive_to_edge(Position& position, bool strong_side, int eval) {
+    const int weak_king = position.king_square[!strong_side];
+    if (position.side_to_move != strong_side) {
+        //a bare king with no square to go to is stalemated, or mated, which the search scores itself
+        const u64 lifted = position.occupied() ^ (1ull << weak_king);
+        const u64 attacked = strong_side ? position.attacked_squares<true>(lifted) : position.attacked_squares<false>(lifted);
+        if (!(king_attacks[weak_king] & ~attacked)) return attacked & (1ull << weak_king) ? eval : 0;
+    }
+    const int bonus = known_win + 20 * center_distance(weak_king) - 10 * distance(position.king_square[strong_side], weak_king);
+    return eval + (position.side_to_move == strong_side ? bonus : -bonus);
+}
+
+//pawns all on one rook file cannot be promoted against a king that holds the corner when the bishop does not cover the promotion square
+static int wrong_bishop(Position& position, bool strong_side, int eval) {
+    constexpr u64 a_file = 0x0101010101010101;
+    constexpr u64 h_file = a_file << 7;
+    constexpr u64 light_squares = 0xaa55aa55aa55aa55;
+    const u64 pawns = position.pieces[black_pawn + strong_side];
+    const u64 file = !(pawns & ~a_file) ? a_file : !(pawns & ~h_file) ? h_file : 0;
+    if (!file) return eval;
+    const int promotion = get_lsb(file & (strong_side ? 0x00000000000000ffull : 0xff00000000000000ull));
+    const bool light_bishop = position.pieces[black_bishop + strong_side] & light_squares;
+    if (light_bishop == static_cast<bool>(light_squares & (1ull << promotion))) return eval;
+    return distance(position.king_square[!strong_side], promotion) <= 1 ? 0 : eval;
+}
+
+//the material key of a king with the given piece types and counts, Piece_types of black, against a bare king
+static u64 signature(bool strong_side, std::initializer_list<std::pair<int, int>> counts) {
+    u64 key = zobrist_pieces[black_king][0] ^ zobrist_pieces[white_king][0];
+    for (const auto& [type, count] : counts) {
+        for (int i{}; i < count; ++i) key ^= zobrist_pieces[type + strong_side][i];
+    }
+    return key;
+}
+
+static std::array<Endgame, endgame_slots> make_endgames() {
+    std::array<Endgame, endgame_slots> table{};
+    const auto add = [&table] (u64 key, bool strong_side, Recognizer recognize) {
+        int slot = key & (endgame_slots - 1);
+        while (table[slot].recognize) slot = (slot + 1) & (endgame_slots - 1);
+        table[slot] = {key, strong_side, recognize};
+    };
+    for (bool strong_side : {false, true}) {
+        add(signature(strong_side, {{black_queen, 1}}), strong_side, drive_to_edge);
+        add(signature(strong_side, {{black_rook, 1}}), strong_side, drive_to_edge);
+        for (int pawns{1}; pawns <= 8; ++pawns) add(signature(strong_side, {{black_bishop, 1}, {black_pawn, pawns}}), strong_side, wrong_bishop);
+    }
+    return table;
+}
+
+static const std::array<Endgame, endgame_slots> endgames = make_endgames();
+
+int scale_endgame(Position& position, int eval) {
+    const u64 key = position.material_key();
+    for (int slot = key & (endgame_slots - 1); endgames[slot].recognize; slot = (slot + 1) & (endgame_slots - 1)) {
+        if (endgames[slot].material_key == key) return endgames[slot].recognize(position, endgames[slot].strong_side, eval);
+    }
+    return eval;
+}
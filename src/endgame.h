@@ -0,0 +1,12 @@
+#ifndef EXOCET_ENDGAME
+#define EXOCET_ENDGAME
+
+#include "board.h"
+
+//endings the search only has to convert score above any evaluation of the network and below the mate scores
+constexpr int known_win = 10000;
+
+//the network's evaluation for the side to move, adjusted by the recognizer of the material if it has one
+int scale_endgame(Position& position, int eval);
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef EXOCET_EVAL_CACHE
+#define EXOCET_EVAL_CACHE
+
+#include "types.h"
+#include <algorithm>
+#include <vector>
+
+//direct-mapped cache of static evaluations, indexed by the low bits of the hash and checked against the high 32
+class Eval_cache {
+    struct Entry {
+        u32 key;
+        i32 eval;
+    };
+    std::vector<Entry> entries;
+    u64 mask{};
+    u64 tag{}; //network version the entries were computed with
+public:
+    u64 probes{};
+    u64 hits{};
+    Eval_cache(int megabytes = 1) {resize(megabytes);}
+    //rounds down to a power of two entries, 0 disables the cache
+    void resize(int megabytes) {
+        u64 count = 1;
+        while (count * 2 * sizeof(Entry) <= static_cast<u64>(megabytes) << 20) count *= 2;
+        entries.assign(megabytes > 0 ? count : 0, Entry{});
+        mask = count - 1;
+        probes = hits = 0;
+    }
+    //new entries of the same size, first touched and so placed on the memory node of the calling thread
+    void reallocate() {
+        std::vector<Entry>(entries.size(), Entry{}).swap(entries);
+    }
+    void clear() {
+        std::fill(entries.begin(), entries.end(), Entry{});
+    }
+    //entries from another network are stale
+    void validate(u64 network_tag) {
+        if (network_tag != tag) clear();
+        tag = network_tag;
+    }
+    inline bool probe(u64 hash, int& eval) {
+        if (entries.empty()) return false;
+        ++probes;
+        const Entry& entry = entries[hash & mask];
+        if (entry.key != static_cast<u32>(hash >> 32)) return false;
+        ++hits;
+        eval = entry.eval;
+        return true;
+    }
+    inline void store(u64 hash, int eval) {
+        if (entries.empty()) return;
+        entries[hash & mask] = {static_cast<u32>(hash >> 32), eval};
+    }
+    inline double hit_rate() {
+        return probes ? 100.0 * hits / probes : 0.0;
+    }
+};
+
+#endif
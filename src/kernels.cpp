@@ -0,0 +1,481 @@
+#include "kernels.h"
+#include "nnue_arch.h"
+#include "simd.h"
+#include <array>
+
+#ifndef KERNEL_ARCH
+#define KERNEL_ARCH native
+#endif
+
+#define KERNEL_STRINGIFY_IMPL(name) #name
+#define KERNEL_STRINGIFY(name) KERNEL_STRINGIFY_IMPL(name)
+
+namespace KERNEL_ARCH {
+
+#ifdef SIMD
+constexpr int hidden_registers = hidden_size / I16_STRIDE;
+constexpr int refresh_registers = hidden_registers < 16 ? hidden_registers : 16; //keep the refresh tile within the register file
+#endif
+
+#ifdef SIMD
+static inline register_type load_weights(const i16* weights) {return *reinterpret_cast<const register_type*>(weights);}
+static inline register_type load_weights(const i8* weights) {return register_load_i8(weights);}
+#endif
+
+template <typename weight_type> void add(i16* accumulator, const weight_type* weights) {
+#ifdef SIMD
+    register_type* output = reinterpret_cast<register_type*>(accumulator);
+    for (int i = 0; i < hidden_registers; ++i) {
+        output[i] = register_add_16(output[i], load_weights(weights + i * I16_STRIDE));
+    }
+#else
+    for (int i = 0; i < hidden_size; ++i) {
+        accumulator[i] += weights[i];
+    }
+#endif
+}
+
+template <typename weight_type> void sub(i16* accumulator, const weight_type* weights) {
+#ifdef SIMD
+    register_type* output = reinterpret_cast<register_type*>(accumulator);
+    for (int i = 0; i < hidden_registers; ++i) {
+        output[i] = register_sub_16(output[i], load_weights(weights + i * I16_STRIDE));
+    }
+#else
+    for (int i = 0; i < hidden_size; ++i) {
+        accumulator[i] -= weights[i];
+    }
+#endif
+}
+
+template <typename weight_type> void sub_add(i16* accumulator, const weight_type* weights_sub, const weight_type* weights_add) {
+#ifdef SIMD
+    register_type* output = reinterpret_cast<register_type*>(accumulator);
+    for (int i = 0; i < hidden_registers; ++i) {
+        output[i] = register_add_16(register_sub_16(output[i], load_weights(weights_sub + i * I16_STRIDE)), load_weights(weights_add + i * I16_STRIDE));
+    }
+#else
+    for (int i = 0; i < hidden_size; ++i) {
+        accumulator[i] += -weights_sub[i] + weights_add[i];
+    }
+#endif
+}
+
+template <typename weight_type> void sub_sub_add(i16* accumulator, const weight_type* weights_sub1, const weight_type* weights_sub2, const weight_type* weights_add) {
+#ifdef SIMD
+    register_type* output = reinterpret_cast<register_type*>(accumulator);
+    for (int i = 0; i < hidden_registers; ++i) {
+        output[i] = register_add_16(register_sub_16(register_sub_16(output[i], load_weights(weights_sub1 + i * I16_STRIDE)), load_weights(weights_sub2 + i * I16_STRIDE)), load_weights(weights_add + i * I16_STRIDE));
+    }
+#else
+    for (int i = 0; i < hidden_size; ++i) {
+        accumulator[i] += -weights_sub1[i] - weights_sub2[i] + weights_add[i];
+    }
+#endif
+}
+
+template <typename weight_type> void refresh(i16* accumulator, const i16* bias, const weight_type* weights, const int* features, int count) {
+#ifdef SIMD
+    register_type* output = reinterpret_cast<register_type*>(accumulator);
+    const register_type* biases = reinterpret_cast<const register_type*>(bias);
+    for (int tile = 0; tile < hidden_registers; tile += refresh_registers) {
+        register_type sums[refresh_registers];
+        for (int i = 0; i < refresh_registers; ++i) sums[i] = biases[tile + i];
+        for (int feature = 0; feature < count; ++feature) {
+            const weight_type* row = weights + features[feature] * hidden_size;
+            for (int i = 0; i < refresh_registers; ++i) sums[i] = register_add_16(sums[i], load_weights(row + (tile + i) * I16_STRIDE));
+        }
+        for (int i = 0; i < refresh_registers; ++i) output[tile + i] = sums[i];
+    }
+#else
+    for (int i = 0; i < hidden_size; ++i) accumulator[i] = bias[i];
+    for (int feature = 0; feature < count; ++feature) {
+        const weight_type* row = weights + features[feature] * hidden_size;
+        for (int i = 0; i < hidden_size; ++i) accumulator[i] += row[i];
+    }
+#endif
+}
+
+//adds one weight row to several accumulators, the row is loaded once and kept in registers while it is added to each
+template <typename weight_type> void add_to_each(i16* const* accumulators, int count, const weight_type* weights) {
+#ifdef SIMD
+    register_type row[hidden_registers];
+    for (int i = 0; i < hidden_registers; ++i) row[i] = load_weights(weights + i * I16_STRIDE);
+    for (int target = 0; target < count; ++target) {
+        register_type* output = reinterpret_cast<register_type*>(accumulators[target]);
+        for (int i = 0; i < hidden_registers; ++i) output[i] = register_add_16(output[i], row[i]);
+    }
+#else
+    for (int target = 0; target < count; ++target) {
+        for (int i = 0; i < hidden_size; ++i) accumulators[target][i] += weights[i];
+    }
+#endif
+}
+
+i32 screlu_dot(const i16* accumulator_us, const i16* accumulator_them, const i16* weights) {
+#ifdef SIMD
+    const register_type screlu_min{};
+    const register_type screlu_max = register_set_16(input_quantization);
+    register_type res{};
+    const register_type* us = reinterpret_cast<const register_type*>(accumulator_us);
+    const register_type* them = reinterpret_cast<const register_type*>(accumulator_them);
+    const register_type* hidden = reinterpret_cast<const register_type*>(weights);
+    for (int i = 0; i < hidden_registers; ++i) {
+        const register_type clipped = register_min_16(register_max_16(us[i], screlu_min), screlu_max);
+        res = register_add_32(res, register_madd_16(register_mul_16(clipped, clipped), hidden[i]));
+    }
+    for (int i = 0; i < hidden_registers; ++i) {
+        const register_type clipped = register_min_16(register_max_16(them[i], screlu_min), screlu_max);
+        res = register_add_32(res, register_madd_16(register_mul_16(clipped, clipped), hidden[i + hidden_registers]));
+    }
+    return register_sum_32(res);
+#else
+    i32 output = 0;
+    for (int i = 0; i < hidden_size; ++i) {
+        const i32 clipped = accumulator_us[i] < 0 ? 0 : (accumulator_us[i] > input_quantization ? input_quantization : accumulator_us[i]);
+        output += clipped * clipped * weights[i];
+    }
+    for (int i = 0; i < hidden_size; ++i) {
+        const i32 clipped = accumulator_them[i] < 0 ? 0 : (accumulator_them[i] > input_quantization ? input_quantization : accumulator_them[i]);
+        output += clipped * clipped * weights[hidden_size + i];
+    }
+    return output;
+#endif
+}
+
+#ifdef SIMD
+static_assert(hidden_registers % 2 == 0, "the int8 output layer packs two registers of activations at a time");
+
+//squared clipped activations of two registers of int8 accumulators, shifted down to 7 bits so that a pair of u8 * i8 products never saturates
+static inline register_type screlu_u8(const register_type* accumulator, const register_type* scale, int i) {
+    const register_type screlu_min{};
+    const register_type screlu_max = register_set_16(input_quantization);
+    const register_type clipped_lo = register_min_16(register_max_16(register_mul_16(accumulator[i], scale[i]), screlu_min), screlu_max);
+    const register_type clipped_hi = register_min_16(register_max_16(register_mul_16(accumulator[i + 1], scale[i + 1]), screlu_min), screlu_max);
+    const register_type squared_lo = register_srli_16(register_mul_16(clipped_lo, clipped_lo), 8);
+    const register_type squared_hi = register_srli_16(register_mul_16(clipped_hi, clipped_hi), 8);
+    return register_unpack_lanes(register_packus_16(squared_lo, squared_hi));
+}
+
+static inline register_type dot_u8_i8(register_type sum, register_type activations, register_type weights) {
+#if defined(__AVX512VNNI__)
+    return _mm512_dpbusd_epi32(sum, activations, weights);
+#else
+    return register_add_32(sum, register_madd_16(register_maddubs_16(activations, weights), register_set_16(1)));
+#endif
+}
+#endif
+
+i32 screlu_dot_i8(const i16* accumulator_us, const i16* accumulator_them, const i16* scale, const i8* weights) {
+#ifdef SIMD
+    register_type res{};
+    const register_type* us = reinterpret_cast<const register_type*>(accumulator_us);
+    const register_type* them = reinterpret_cast<const register_type*>(accumulator_them);
+    const register_type* scales = reinterpret_cast<const register_type*>(scale);
+    const register_type* hidden = reinterpret_cast<const register_type*>(weights);
+    for (int i = 0; i < hidden_registers; i += 2) {
+        res = dot_u8_i8(res, screlu_u8(us, scales, i), hidden[i / 2]);
+    }
+    for (int i = 0; i < hidden_registers; i += 2) {
+        res = dot_u8_i8(res, screlu_u8(them, scales, i), hidden[(i + hidden_registers) / 2]);
+    }
+    return register_sum_32(res);
+#else
+    i32 output = 0;
+    for (int i = 0; i < hidden_size; ++i) {
+        const i32 value = accumulator_us[i] * scale[i];
+        const i32 clipped = value < 0 ? 0 : (value > input_quantization ? input_quantization : value);
+        output += ((clipped * clipped) >> 8) * weights[i];
+    }
+    for (int i = 0; i < hidden_size; ++i) {
+        const i32 value = accumulator_them[i] * scale[i];
+        const i32 clipped = value < 0 ? 0 : (value > input_quantization ? input_quantization : value);
+        output += ((clipped * clipped) >> 8) * weights[hidden_size + i];
+    }
+    return output;
+#endif
+}
+
+//indices of the set bits of every 4-bit mask, used to turn comparison masks into lists of non-zero input chunks
+struct Nibble_table {
+    u8 indices[16][4];
+    u8 count[16];
+};
+
+constexpr Nibble_table make_nibble_table() {
+    Nibble_table table{};
+    for (int mask = 0; mask < 16; ++mask) {
+        for (int bit = 0; bit < 4; ++bit) {
+            if (mask & (1 << bit)) table.indices[mask][table.count[mask]++] = bit;
+        }
+    }
+    return table;
+}
+
+constexpr Nibble_table nibble_table = make_nibble_table();
+
+//writes the indices of the non-zero 4-byte chunks of the input, up to 3 entries past the returned count are scratch
+template <int chunks> int find_nonzero_chunks(const i32* input, u16* indices) {
+    int count = 0;
+#ifdef SIMD
+    static_assert(chunks % I32_STRIDE == 0, "chunks must fill whole registers");
+    for (int i = 0; i < chunks; i += I32_STRIDE) {
+        //activations are at most 127 so a chunk is positive exactly when it is non-zero
+        const unsigned mask = register_positive_mask_32(*reinterpret_cast<const register_type*>(input + i));
+        for (int nibble = 0; nibble < I32_STRIDE; nibble += 4) {
+            const int bits = (mask >> nibble) & 0xF;
+            for (int j = 0; j < 4; ++j) indices[count + j] = i + nibble + nibble_table.indices[bits][j];
+            count += nibble_table.count[bits];
+        }
+    }
+#else
+    for (int i = 0; i < chunks; ++i) {
+        if (input[i]) indices[count++] = i;
+    }
+#endif
+    return count;
+}
+
+//u8 inputs times i8 weights, only visiting the input chunks that are non-zero
+template <int input_dims, int output_dims> void affine_sparse(const u8* input, const i8* weights, const i32* bias, i32* output) {
+    constexpr int chunks = input_dims / 4;
+    const i32* input_chunks = reinterpret_cast<const i32*>(input);
+    u16 nonzero[chunks + 4];
+    const int count = find_nonzero_chunks<chunks>(input_chunks, nonzero);
+#ifdef SIMD
+    constexpr int output_registers = output_dims / I32_STRIDE;
+    register_type sums[output_registers];
+    for (int i = 0; i < output_registers; ++i) sums[i] = reinterpret_cast<const register_type*>(bias)[i];
+    for (int i = 0; i < count; ++i) {
+        const register_type value = register_set_32(input_chunks[nonzero[i]]);
+        const register_type* rows = reinterpret_cast<const register_type*>(weights + nonzero[i] * output_dims * 4);
+        for (int j = 0; j < output_registers; ++j) sums[j] = dot_u8_i8(sums[j], value, rows[j]);
+    }
+    for (int i = 0; i < output_registers; ++i) reinterpret_cast<register_type*>(output)[i] = sums[i];
+#else
+    for (int i = 0; i < output_dims; ++i) output[i] = bias[i];
+    for (int i = 0; i < count; ++i) {
+        const int chunk = nonzero[i];
+        for (int j = 0; j < output_dims; ++j) {
+            for (int k = 0; k < 4; ++k) output[j] += input[chunk * 4 + k] * weights[(chunk * output_dims + j) * 4 + k];
+        }
+    }
+#endif
+}
+
+template <int input_dims, int output_dims> void affine_dense(const u8* input, const i8* weights, const i32* bias, i32* output) {
+    constexpr int chunks = input_dims / 4;
+#ifdef SIMD
+    constexpr int output_registers = output_dims / I32_STRIDE;
+    const i32* input_chunks = reinterpret_cast<const i32*>(input);
+    register_type sums[output_registers];
+    for (int i = 0; i < output_registers; ++i) sums[i] = reinterpret_cast<const register_type*>(bias)[i];
+    for (int chunk = 0; chunk < chunks; ++chunk) {
+        const register_type value = register_set_32(input_chunks[chunk]);
+        const register_type* rows = reinterpret_cast<const register_type*>(weights + chunk * output_dims * 4);
+        for (int j = 0; j < output_registers; ++j) sums[j] = dot_u8_i8(sums[j], value, rows[j]);
+    }
+    for (int i = 0; i < output_registers; ++i) reinterpret_cast<register_type*>(output)[i] = sums[i];
+#else
+    for (int i = 0; i < output_dims; ++i) output[i] = bias[i];
+    for (int chunk = 0; chunk < chunks; ++chunk) {
+        for (int j = 0; j < output_dims; ++j) {
+            for (int k = 0; k < 4; ++k) output[j] += input[chunk * 4 + k] * weights[(chunk * output_dims + j) * 4 + k];
+        }
+    }
+#endif
+}
+
+template <int dims> void clipped_relu(const i32* input, u8* output) {
+    for (int i = 0; i < dims; ++i) {
+        const i32 shifted = input[i] >> layer_shift;
+        output[i] = shifted < 0 ? 0 : (shifted > 127 ? 127 : shifted);
+    }
+}
+
+template <int l1, int l2> i32 propagate(const i16* accumulator_us, const i16* accumulator_them, const i16* scale, const Layer_weights& weights) {
+    if constexpr (l1 == 0) {
+        return 0;
+    } else {
+        alignas(ALIGNMENT) u8 transformed[hidden_dsize];
+#ifdef SIMD
+        register_type* packed = reinterpret_cast<register_type*>(transformed);
+        const register_type* us = reinterpret_cast<const register_type*>(accumulator_us);
+        const register_type* them = reinterpret_cast<const register_type*>(accumulator_them);
+        const register_type* scales = reinterpret_cast<const register_type*>(scale);
+        for (int i = 0; i < hidden_registers; i += 2) packed[i / 2] = screlu_u8(us, scales, i);
+        for (int i = 0; i < hidden_registers; i += 2) packed[(i + hidden_registers) / 2] = screlu_u8(them, scales, i);
+#else
+        for (int i = 0; i < hidden_dsize; ++i) {
+            const i32 value = (i < hidden_size ? accumulator_us[i] : accumulator_them[i - hidden_size]) * scale[i % hidden_size];
+            const i32 clipped = value < 0 ? 0 : (value > input_quantization ? input_quantization : value);
+            transformed[i] = (clipped * clipped) >> 8;
+        }
+#endif
+        alignas(ALIGNMENT) i32 l1_output[l1];
+        alignas(ALIGNMENT) u8 l1_activated[l1];
+        alignas(ALIGNMENT) i32 l2_output[l2];
+        alignas(ALIGNMENT) u8 l2_activated[l2];
+        affine_sparse<hidden_dsize, l1>(transformed, weights.l1_weights, weights.l1_bias, l1_output);
+        clipped_relu<l1>(l1_output, l1_activated);
+        affine_dense<l1, l2>(l1_activated, weights.l2_weights, weights.l2_bias, l2_output);
+        clipped_relu<l2>(l2_output, l2_activated);
+        i32 output = weights.output_bias;
+        for (int i = 0; i < l2; ++i) output += l2_activated[i] * weights.output_weights[i];
+        return output;
+    }
+}
+
+//a8 is square 0, so the rays east, south, southwest and southeast are left shifts by 1, 8, 7 and 9 and their opposites are right shifts,
+//the file masks drop what wraps around the board edge
+constexpr u64 not_a_file = 0xfefefefefefefefe;
+constexpr u64 not_h_file = 0x7f7f7f7f7f7f7f7f;
+
+//set-wise leaper attacks, shared by every instruction set
+static u64 knight_fill(u64 knights) {
+    const u64 left1 = (knights >> 1) & not_h_file;
+    const u64 left2 = (knights >> 2) & 0x3f3f3f3f3f3f3f3f;
+    const u64 right1 = (knights << 1) & not_a_file;
+    const u64 right2 = (knights << 2) & 0xfcfcfcfcfcfcfcfc;
+    const u64 one_file = left1 | right1;
+    const u64 two_files = left2 | right2;
+    return (one_file << 16) | (one_file >> 16) | (two_files << 8) | (two_files >> 8);
+}
+
+static u64 king_fill(u64 king) {
+    const u64 row = king | ((king >> 1) & not_h_file) | ((king << 1) & not_a_file);
+    return (row | (row << 8) | (row >> 8)) ^ king;
+}
+
+#if defined(__AVX512F__)
+//lanes 0-3 hold the rook and bishop rays, lanes 4-7 the same rays of the queens
+static inline __m512i slide_fill(__m512i sliders, __m512i empty, __m512i shift, __m512i wrap, bool left) {
+    empty = _mm512_and_si512(empty, wrap);
+    for (int step = 0; step < 3; ++step) {
+        sliders = _mm512_or_si512(sliders, _mm512_and_si512(empty, left ? _mm512_sllv_epi64(sliders, shift) : _mm512_srlv_epi64(sliders, shift)));
+        empty = _mm512_and_si512(empty, left ? _mm512_sllv_epi64(empty, shift) : _mm512_srlv_epi64(empty, shift));
+        shift = _mm512_add_epi64(shift, shift);
+    }
+    shift = _mm512_srli_epi64(shift, 3);
+    return _mm512_and_si512(left ? _mm512_sllv_epi64(sliders, shift) : _mm512_srlv_epi64(sliders, shift), wrap);
+}
+#elif defined(__AVX2__)
+//the first register holds the rook and bishop rays, the second the same rays of the queens
+static inline __m256i slide_fill(__m256i sliders, __m256i empty, __m256i shift, __m256i wrap, bool left) {
+    empty = _mm256_and_si256(empty, wrap);
+    for (int step = 0; step < 3; ++step) {
+        sliders = _mm256_or_si256(sliders, _mm256_and_si256(empty, left ? _mm256_sllv_epi64(sliders, shift) : _mm256_srlv_epi64(sliders, shift)));
+        empty = _mm256_and_si256(empty, left ? _mm256_sllv_epi64(empty, shift) : _mm256_srlv_epi64(empty, shift));
+        shift = _mm256_add_epi64(shift, shift);
+    }
+    shift = _mm256_srli_epi64(shift, 3);
+    return _mm256_and_si256(left ? _mm256_sllv_epi64(sliders, shift) : _mm256_srlv_epi64(sliders, shift), wrap);
+}
+#else
+constexpr int ray_shifts[4] {1, 8, 7, 9};
+constexpr u64 left_wraps[4] {not_a_file, ~0ull, not_h_file, not_a_file};
+constexpr u64 right_wraps[4] {not_h_file, ~0ull, not_a_file, not_h_file};
+
+//scalar occluded fill of one ray
+static inline u64 slide_fill(u64 sliders, u64 empty, int shift, u64 wrap, bool left) {
+    empty &= wrap;
+    for (int step = 0; step < 3; ++step) {
+        sliders |= empty & (left ? sliders << shift : sliders >> shift);
+        empty &= left ? empty << shift : empty >> shift;
+        shift *= 2;
+    }
+    shift /= 8;
+    return (left ? sliders << shift : sliders >> shift) & wrap;
+}
+#endif
+
+void attack_maps(const u64* pieces, bool side, u64 occupied, Attack_maps& maps) {
+    const u64 pawns = pieces[side];
+    const u64 rooks = pieces[6 + side];
+    const u64 bishops = pieces[4 + side];
+    const u64 queens = pieces[8 + side];
+    const u64 empty = ~occupied;
+    //per ray: the rooks fill the orthogonal rays, the bishops the diagonal ones and the queens all four
+    alignas(ALIGNMENT) u64 rays[8];
+#if defined(__AVX512F__)
+    const __m512i sliders = _mm512_mask_set1_epi64(_mm512_mask_set1_epi64(_mm512_set1_epi64(queens), 0x03, rooks), 0x0c, bishops); //broadcasts, not a trip through the stack
+    const __m512i shifts = _mm512_setr_epi64(1, 8, 7, 9, 1, 8, 7, 9);
+    const __m512i left_wrap = _mm512_setr_epi64(not_a_file, ~0ull, not_h_file, not_a_file, not_a_file, ~0ull, not_h_file, not_a_file);
+    const __m512i right_wrap = _mm512_setr_epi64(not_h_file, ~0ull, not_a_file, not_h_file, not_h_file, ~0ull, not_a_file, not_h_file);
+    const __m512i empties = _mm512_set1_epi64(empty);
+    _mm512_store_si512(rays, _mm512_or_si512(slide_fill(sliders, empties, shifts, left_wrap, true), slide_fill(sliders, empties, shifts, right_wrap, false)));
+#elif defined(__AVX2__)
+    const __m256i shifts = _mm256_setr_epi64x(1, 8, 7, 9);
+    const __m256i left_wrap = _mm256_setr_epi64x(not_a_file, ~0ull, not_h_file, not_a_file);
+    const __m256i right_wrap = _mm256_setr_epi64x(not_h_file, ~0ull, not_a_file, not_h_file);
+    const __m256i empties = _mm256_set1_epi64x(empty);
+    const __m256i rooks_bishops = _mm256_blend_epi32(_mm256_set1_epi64x(rooks), _mm256_set1_epi64x(bishops), 0xf0);
+    const __m256i all_queens = _mm256_set1_epi64x(queens);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(rays), _mm256_or_si256(slide_fill(rooks_bishops, empties, shifts, left_wrap, true), slide_fill(rooks_bishops, empties, shifts, right_wrap, false)));
+    _mm256_store_si256(reinterpret_cast<__m256i*>(rays + 4), _mm256_or_si256(slide_fill(all_queens, empties, shifts, left_wrap, true), slide_fill(all_queens, empties, shifts, right_wrap, false)));
+#else
+    for (int ray = 0; ray < 8; ++ray) {
+        const u64 generator = ray >= 4 ? queens : (ray < 2 ? rooks : bishops);
+        rays[ray] = slide_fill(generator, empty, ray_shifts[ray % 4], left_wraps[ray % 4], true) | slide_fill(generator, empty, ray_shifts[ray % 4], right_wraps[ray % 4], false);
+    }
+#endif
+    if (side) maps.by_type[0] = ((pawns & not_a_file) >> 9) | ((pawns & not_h_file) >> 7);
+    else maps.by_type[0] = ((pawns & not_a_file) << 7) | ((pawns & not_h_file) << 9);
+    maps.by_type[1] = knight_fill(pieces[2 + side]);
+    maps.by_type[2] = rays[2] | rays[3];
+    maps.by_type[3] = rays[0] | rays[1];
+    maps.by_type[4] = rays[4] | rays[5] | rays[6] | rays[7];
+    maps.by_type[5] = king_fill(pieces[10 + side]);
+    maps.all = maps.by_type[0] | maps.by_type[1] | maps.by_type[2] | maps.by_type[3] | maps.by_type[4] | maps.by_type[5];
+}
+
+#if defined(__AVX512VBMI2__)
+constexpr auto make_end_squares() {
+    std::array<u16, 64> table{};
+    for (int square{}; square < 64; ++square) table[square] = static_cast<u16>(square << 6);
+    return table;
+}
+
+alignas(64) constexpr auto end_squares = make_end_squares(); //the end field of a move to each square
+
+//two compresses of the end fields selected by each half of the target set
+int add_targets(u16* moves, int start, u64 targets) {
+    const __m512i origin = _mm512_set1_epi16(static_cast<short>(start));
+    const __m512i low = _mm512_maskz_compress_epi16(static_cast<__mmask32>(targets), _mm512_load_si512(end_squares.data()));
+    _mm512_storeu_si512(moves, _mm512_or_si512(low, origin));
+    int count = __builtin_popcount(static_cast<u32>(targets));
+    if (targets >> 32) {
+        const __m512i high = _mm512_maskz_compress_epi16(static_cast<__mmask32>(targets >> 32), _mm512_load_si512(end_squares.data() + 32));
+        _mm512_storeu_si512(moves + count, _mm512_or_si512(high, origin));
+        count += __builtin_popcount(static_cast<u32>(targets >> 32));
+    }
+    return count;
+}
+#endif
+
+extern const Kernels table {
+    KERNEL_STRINGIFY(KERNEL_ARCH),
+    add<i16>,
+    sub<i16>,
+    sub_add<i16>,
+    sub_sub_add<i16>,
+    refresh<i16>,
+    screlu_dot,
+    add<i8>,
+    sub<i8>,
+    sub_add<i8>,
+    sub_sub_add<i8>,
+    refresh<i8>,
+    screlu_dot_i8,
+    propagate<l1_size, l2_size>,
+    add_to_each<i16>,
+    add_to_each<i8>,
+    attack_maps,
+#if defined(__AVX512VBMI2__)
+    add_targets,
+#else
+    nullptr,
+#endif
+};
+
+}
@@ -0,0 +1,66 @@
+#ifndef EXOCET_KERNELS
+#define EXOCET_KERNELS
+
+#include "types.h"
+#include <string>
+
+//dense layers of the multi-layer architecture, the weights of each layer grouped by 4-input chunk
+struct Layer_weights {
+    const i8* l1_weights;
+    const i32* l1_bias;
+    const i8* l2_weights;
+    const i32* l2_bias;
+    const i8* output_weights;
+    i32 output_bias;
+};
+
+//squares attacked by each piece type of one side, pawn to king, and their union
+struct Attack_maps {
+    u64 by_type[6];
+    u64 all;
+};
+
+//kernels.cpp is built once per instruction set, each copy in its own namespace
+//only raw pointers cross this boundary so that no inline code is shared between the copies
+struct Kernels {
+    const char* name;
+    void (*add)(i16* accumulator, const i16* weights);
+    void (*sub)(i16* accumulator, const i16* weights);
+    void (*sub_add)(i16* accumulator, const i16* weights_sub, const i16* weights_add);
+    void (*sub_sub_add)(i16* accumulator, const i16* weights_sub1, const i16* weights_sub2, const i16* weights_add);
+    void (*refresh)(i16* accumulator, const i16* bias, const i16* weights, const int* features, int count);
+    i32 (*screlu_dot)(const i16* accumulator_us, const i16* accumulator_them, const i16* weights);
+    //int8 feature weights widened into the same int16 accumulators
+    void (*add_i8)(i16* accumulator, const i8* weights);
+    void (*sub_i8)(i16* accumulator, const i8* weights);
+    void (*sub_add_i8)(i16* accumulator, const i8* weights_sub, const i8* weights_add);
+    void (*sub_sub_add_i8)(i16* accumulator, const i8* weights_sub1, const i8* weights_sub2, const i8* weights_add);
+    void (*refresh_i8)(i16* accumulator, const i16* bias, const i8* weights, const int* features, int count);
+    i32 (*screlu_dot_i8)(const i16* accumulator_us, const i16* accumulator_them, const i16* scale, const i8* weights);
+    i32 (*propagate)(const i16* accumulator_us, const i16* accumulator_them, const i16* scale, const Layer_weights& weights);
+    //adds one feature's weights to every accumulator of a list, for batches of positions that share the feature
+    void (*add_to_each)(i16* const* accumulators, int count, const i16* weights);
+    void (*add_to_each_i8)(i16* const* accumulators, int count, const i8* weights);
+    //pieces is indexed like Position::pieces, the sliders of every type are filled in all their directions at once
+    void (*attack_maps)(const u64* pieces, bool side, u64 occupied, Attack_maps& maps);
+    //writes a move from start to every square of targets and returns how many, may store up to 32 moves past them,
+    //null where the instruction set has no compress and the movelist pops one bit at a time instead
+    int (*add_targets)(u16* moves, int start, u64 targets);
+};
+
+#ifdef KERNEL_DISPATCH
+namespace generic {extern const Kernels table;}
+namespace avx2 {extern const Kernels table;}
+namespace avx512 {extern const Kernels table;}
+namespace vnni {extern const Kernels table;}
+namespace vbmi2 {extern const Kernels table;}
+#else
+namespace native {extern const Kernels table;}
+#endif
+
+extern const Kernels* kernels;
+
+bool select_kernels(const std::string& name = "");
+std::string supported_kernels();
+
+#endif
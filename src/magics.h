@@ -3,7 +3,7 @@
 
 #include "types.h"
 
-const u64 rook_premask[64] {
+inline constexpr u64 rook_premask[64] {
     0x101010101017e,    0x202020202027c,    0x404040404047a,    0x8080808080876,    0x1010101010106e,   0x2020202020205e,   0x4040404040403e,   0x8080808080807e,
     0x1010101017e00,    0x2020202027c00,    0x4040404047a00,    0x8080808087600,    0x10101010106e00,   0x20202020205e00,   0x40404040403e00,   0x80808080807e00,
     0x10101017e0100,    0x20202027c0200,    0x40404047a0400,    0x8080808760800,    0x101010106e1000,   0x202020205e2000,   0x404040403e4000,   0x808080807e8000,
@@ -13,7 +13,7 @@ const u64 rook_premask[64] {
     0x7e010101010100,   0x7c020202020200,   0x7a040404040400,   0x76080808080800,   0x6e101010101000,   0x5e202020202000,   0x3e404040404000,   0x7e808080808000,
     0x7e01010101010100, 0x7c02020202020200, 0x7a04040404040400, 0x7608080808080800, 0x6e10101010101000, 0x5e20202020202000, 0x3e40404040404000, 0x7e80808080808000,
 };
-const u64 bishop_premask[64] {
+inline constexpr u64 bishop_premask[64] {
     0x40201008040200,   0x402010080400,     0x4020100a00,       0x40221400,         0x2442800,          0x204085000,        0x20408102000,      0x2040810204000,
     0x20100804020000,   0x40201008040000,   0x4020100a0000,     0x4022140000,       0x244280000,        0x20408500000,      0x2040810200000,    0x4081020400000,
     0x10080402000200,   0x20100804000400,   0x4020100a000a00,   0x402214001400,     0x24428002800,      0x2040850005000,    0x4081020002000,    0x8102040004000,
@@ -24,7 +24,12 @@ const u64 bishop_premask[64] {
     0x2040810204000,    0x4081020400000,    0xa102040000000,    0x14224000000000,   0x28440200000000,   0x50080402000000,   0x20100804020000,   0x40201008040200,
 };
 
-const struct {u64 magic; int start;} bishop_magics[64] {
+struct Magic {
+    u64 magic;
+    int start;
+};
+
+inline constexpr Magic bishop_magics[64] {
     { 0x007bfeffbfeffbffull,  16530 },
     { 0x003effbfeffbfe08ull,   9162 },
     { 0x0000401020200000ull,   9674 },
@@ -91,7 +96,7 @@ const struct {u64 magic; int start;} bishop_magics[64] {
     { 0x007ffdff7fdff7fdull,   6166 }
 };
 
-const struct {u64 magic; int start;} rook_magics[64] {
+inline constexpr Magic rook_magics[64] {
     { 0x00a801f7fbfeffffull,  85487 },
     { 0x00180012000bffffull,  43101 },
     { 0x0040080010004004ull,      0 },
@@ -158,6 +163,7 @@ const struct {u64 magic; int start;} rook_magics[64] {
     { 0x0001ffff99ffab2full,  21479 }
 };
 
-static u64 lookup_table[97264];
+constexpr int lookup_table_size = 97264; //bishop and rook attack sets share the table, overlapping where they agree
+constexpr int pext_table_size = 107648; //one entry per subset of every premask, for the pext backend
 
 #endif
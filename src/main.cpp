@@ -1,15 +1,29 @@
 #include "main.h"
+#include "kernels.h"
 #include "nnue.h"
 #include "search.h"
+#include "startup.h"
 #include "uci.h"
 #include <cassert>
 #include <iostream>
 #include <sstream>
 
 int main(int argc, char *argv[]) {
-    nnue_init();
+    if (argc > 1 && std::string{argv[1]} == "startup") {
+        return startup_bench(argc > 2 ? std::stoi(argv[2]) : 100);
+    }
+    select_kernels();
+    if (!nnue_init()) {
+        std::cout << "info string error no net matches this build, dense layers of " << l1_size << " and " << l2_size
+                  << " need EVALFILE set to a net trained for them" << std::endl;
+        return 1;
+    }
     Uci uci;
     if (argc > 1 && std::string{argv[1]} == "bench") {
+        if (argc > 2 && !select_kernels(argv[2])) {
+            std::cout << "unsupported kernels \"" << argv[2] << "\", available: " << supported_kernels() << std::endl;
+            return 1;
+        }
         uci.handle_bench();
         return 0;
     } else if (argc > 1) {
@@ -24,25 +38,70 @@ int main(int argc, char *argv[]) {
         std::istringstream parser(command);
         while (parser >> token) {tokens.push_back(token);}
         if (tokens.size() == 0) {continue;}
+        if (tokens[0] == "attackbench") {
+            uci.handle_attackbench();
+        }
+        if (tokens[0] == "bench") {
+            uci.handle_bench();
+        }
+        if (tokens[0] == "evalfens") {
+            uci.handle_evalfens(tokens);
+        }
+        if (tokens[0] == "exportnet") {
+            uci.handle_exportnet(tokens);
+        }
+        if (tokens[0] == "fuzzlegality") {
+            uci.handle_fuzzlegality(tokens);
+        }
         if (tokens[0] == "go") {
             uci.handle_go(tokens);
         }
         if (tokens[0] == "isready") {
             uci.handle_isready();
         }
+        if (tokens[0] == "makebench") {
+            uci.handle_makebench(tokens);
+        }
+        if (tokens[0] == "movegenbench") {
+            uci.handle_movegenbench();
+        }
+        if (tokens[0] == "numabench") {
+            uci.handle_numabench(tokens);
+        }
         if (tokens[0] == "perft") {
             uci.handle_perft(tokens);
         }
+        if (tokens[0] == "perftchecks") {
+            uci.handle_perftchecks(tokens);
+        }
         if (tokens[0] == "perftsplit") {
             uci.handle_perftsplit(tokens);
         }
         if (tokens[0] == "position") {
             uci.handle_position(tokens);
         }
+        if (tokens[0] == "prefetchbench") {
+            uci.handle_prefetchbench();
+        }
+        if (tokens[0] == "propagatechecks") {
+            uci.handle_propagatechecks(tokens);
+        }
         if (tokens[0] == "quit") {
             uci.handle_quit();
             return 0;
         }
+        if (tokens[0] == "reloadnet") {
+            uci.handle_reloadnet();
+        }
+        if (tokens[0] == "repetitionchecks") {
+            uci.handle_repetitionchecks(tokens);
+        }
+        if (tokens[0] == "setoption") {
+            uci.handle_setoption(tokens);
+        }
+        if (tokens[0] == "sliderbench") {
+            uci.handle_sliderbench();
+        }
         if (tokens[0] == "stop") {
             uci.handle_stop();
         }
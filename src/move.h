@@ -27,59 +27,31 @@ enum Flags {
     enpassant,
 };
 
-//24 bits
-//PPPPSSSSSSCCCCEEEEEEEFFF
-//321098765432109876543210
-//842184218421842184218421
+//16 bits, the moving and captured pieces are read from the board
+//FFFFEEEEEESSSSSS
+//5432109876543210
 
 struct Move {
-    Move() {
-        data = (12 << 20) ^ (12 << 16) ^ (0 << 10) ^ (64 << 3) ^ none;
-    }
-    Move(int piece, int start_square, int captured_piece, int end_square, int flag = none) {
-        data = (piece << 20) ^ (captured_piece << 16) ^ (start_square << 10) ^ (end_square << 3) ^ flag;
-    }
-    Move(const Move& rhs) {
-        data = rhs.data;
-    }
-    Move& operator=(const Move& rhs) {
-        if (this == &rhs) return *this;
-        data = rhs.data;
-        return *this;
-    }
-    Move (const u64 move_data) {
-        data = move_data;
-    }
-    inline constexpr int flag() const {return data & 0x7;}
-    inline constexpr int piece() const {return (data >> 20) & 0xF;}
-    inline constexpr int start() const {return (data >> 10) & 0x3F;}
-    inline constexpr int captured() const {return (data >> 16) & 0xF;}
-    inline constexpr int end() const {return (data >> 3) & 0x7F;}
-    inline constexpr bool is_null() const {return (data & 0x200);}
-    inline void add_sortkey(int key) {data = (data & 0xFFFFFFFF) | (static_cast<u64>(key) << 32);}
-    inline constexpr int sortkey() const{return data >> 32;}
-    inline int mvv_lva() const {
-        if (flag() == queen_pr) return 384;
-        if (flag() != none && !(flag() & 4)) return 0;
-        return (captured() << 5) + piece() ^ 15;
-    }
-    u64 data;
+    constexpr Move() = default;
+    constexpr Move(int start_square, int end_square, int flag = none) : data(static_cast<u16>(start_square ^ (end_square << 6) ^ (flag << 12))) {}
+    inline constexpr int flag() const {return data >> 12;}
+    inline constexpr int start() const {return data & 0x3F;}
+    inline constexpr int end() const {return (data >> 6) & 0x3F;}
+    inline constexpr bool is_null() const {return !data;} //a8a8, which no move can be
+    u16 data{};
 };
 
 inline bool operator==(const Move& move1, const Move& move2) {
-    return (move1.data & 0xFFFFFF) == (move2.data & 0xFFFFFF);
+    return move1.data == move2.data;
 }
 
 inline bool operator!=(const Move& move1, const Move& move2) {
-    return (move1.data & 0xFFFFFF) != (move2.data & 0xFFFFFF);
-}
-
-inline bool operator<(const Move& move1, const Move& move2) {
-    return move1.data > move2.data;//reversed so higher sortkeys go first by default
+    return move1.data != move2.data;
 }
 
 inline std::ostream& operator<<(std::ostream& out, const Move move) {
-    if (move.flag() == q_castling) out << square_names[move.start()] << square_names[move.end() + 2];
+    if (move.is_null()) out << "0000";
+    else if (move.flag() == q_castling) out << square_names[move.start()] << square_names[move.end() + 2];
     else if (move.flag() == k_castling) out << square_names[move.start()] << square_names[move.end() - 1];
     else out << square_names[move.start()] << square_names[move.end()];
     if (move.flag() == knight_pr) out << "n";
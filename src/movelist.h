@@ -0,0 +1,43 @@
+#ifndef EXOCET_MOVELIST
+#define EXOCET_MOVELIST
+
+#include "bits.h"
+#include "kernels.h"
+#include "move.h"
+#include "types.h"
+
+constexpr int max_moves = 220;
+
+//moves and their ordering scores in separate arrays, generation only writes the 2 byte moves and ordering only touches the scores
+class Movelist {
+    Move moves[max_moves + 32]; //the compress kernel stores 32 moves whatever the count
+    i32 scores[max_moves];
+    int count{};
+public:
+    inline int size() {return count;}
+    inline void add(Move move) {moves[count++] = move;}
+    inline void clear() {count = 0;}
+    //a move from start to every square of targets, in ascending order of end square
+    inline void add_targets(int start, u64 targets) {
+        if (kernels->add_targets) count += kernels->add_targets(reinterpret_cast<u16*>(moves + count), start, targets);
+        else while (targets) moves[count++] = Move{start, pop_lsb(targets)};
+    }
+    inline Move& operator[](int index) {return moves[index];}
+    inline i32& score(int index) {return scores[index];}
+    //highest score first, equal scores keep their generation order
+    inline void sort(int start, int end) {
+        for (int i{start + 1}; i < end; ++i) {
+            const Move move = moves[i];
+            const i32 score = scores[i];
+            int j = i;
+            for (; j > start && scores[j - 1] < score; --j) {
+                moves[j] = moves[j - 1];
+                scores[j] = scores[j - 1];
+            }
+            moves[j] = move;
+            scores[j] = score;
+        }
+    }
+};
+
+#endif
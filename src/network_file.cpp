@@ -0,0 +1,146 @@
+#include "network_file.h"
+#include "nnue_arch.h"
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+u64 network_checksum(const unsigned char* data, u64 size) {
+    //64-bit FNV-1a
+    u64 hash = 14695981039346656037ULL;
+    for (u64 i{}; i < size; ++i) {
+        hash ^= data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static std::string mismatch(const char* field, u64 found, u64 expected) {
+    return std::string(field) + " " + std::to_string(found) + " does not match the engine's " + std::to_string(expected);
+}
+
+static bool validate(const unsigned char* data, u64 size, std::string& error) {
+    if (size < sizeof(Network_header)) {
+        error = "file has " + std::to_string(size) + " bytes, too small for a network header";
+        return false;
+    }
+    Network_header header;
+    std::memcpy(&header, data, sizeof(Network_header));
+    if (std::memcmp(header.magic, network_magic, sizeof(network_magic)) != 0) error = "not an exocet network file";
+    else if (header.version != network_version) error = mismatch("format version", header.version, network_version);
+    else if (header.input_size != input_size) error = mismatch("input size", header.input_size, input_size);
+    else if (header.hidden_size != hidden_size) error = mismatch("hidden size", header.hidden_size, hidden_size);
+    else if (header.l1_size != l1_size) error = mismatch("l1 size", header.l1_size, l1_size);
+    else if (header.l2_size != l2_size) error = mismatch("l2 size", header.l2_size, l2_size);
+    else if (header.payload_bytes != network_bytes) error = mismatch("payload size", header.payload_bytes, network_bytes);
+    else if (size != sizeof(Network_header) + network_bytes) error = mismatch("file size", size, sizeof(Network_header) + network_bytes);
+    else if (network_checksum(data + sizeof(Network_header), network_bytes) != header.checksum) error = "checksum mismatch, the file is corrupt";
+    else return true;
+    return false;
+}
+
+bool Network_file::open(const std::string& path, std::string& error) {
+    close();
+#ifdef _WIN32
+    std::ifstream fin(path, std::ios::binary | std::ios::ate);
+    if (!fin) {
+        error = "could not open " + path;
+        return false;
+    }
+    buffer.resize(static_cast<u64>(fin.tellg()));
+    fin.seekg(0);
+    fin.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+    if (!fin) {
+        error = "could not read " + path;
+        buffer.clear();
+        return false;
+    }
+    const unsigned char* data = buffer.data();
+    const u64 size = buffer.size();
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = "could not open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat status;
+    if (fstat(fd, &status) != 0 || status.st_size <= 0) {
+        error = "could not read " + path;
+        ::close(fd);
+        return false;
+    }
+    int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+    flags |= MAP_POPULATE; //fault the pages in now, the checksum touches all of them anyway
+#endif
+    void* address = mmap(nullptr, status.st_size, PROT_READ, flags, fd, 0);
+    ::close(fd);
+    if (address == MAP_FAILED) {
+        error = "could not map " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    mapping = static_cast<unsigned char*>(address);
+    mapped_bytes = status.st_size;
+    device = status.st_dev;
+    inode = status.st_ino;
+    modified = static_cast<i64>(status.st_mtim.tv_sec) * 1000000000 + status.st_mtim.tv_nsec;
+    const unsigned char* data = mapping;
+    const u64 size = mapped_bytes;
+#endif
+    if (!validate(data, size, error)) {
+        close();
+        return false;
+    }
+    payload_data = data + sizeof(Network_header);
+    return true;
+}
+
+bool Network_file::unchanged(const std::string& path) const {
+#ifdef _WIN32
+    return false;
+#else
+    struct stat status;
+    if (!mapping || stat(path.c_str(), &status) != 0) return false;
+    return static_cast<u64>(status.st_dev) == device && static_cast<u64>(status.st_ino) == inode && static_cast<u64>(status.st_size) == mapped_bytes
+        && static_cast<i64>(status.st_mtim.tv_sec) * 1000000000 + status.st_mtim.tv_nsec == modified;
+#endif
+}
+
+void Network_file::close() {
+#ifndef _WIN32
+    if (mapping) munmap(mapping, mapped_bytes);
+#endif
+    mapping = nullptr;
+    mapped_bytes = 0;
+    device = inode = 0;
+    modified = 0;
+    buffer.clear();
+    buffer.shrink_to_fit();
+    payload_data = nullptr;
+}
+
+bool write_network_file(const std::string& path, const unsigned char* payload, std::string& error) {
+    Network_header header{};
+    std::memcpy(header.magic, network_magic, sizeof(network_magic));
+    header.version = network_version;
+    header.input_size = input_size;
+    header.hidden_size = hidden_size;
+    header.l1_size = l1_size;
+    header.l2_size = l2_size;
+    header.payload_bytes = network_bytes;
+    header.checksum = network_checksum(payload, network_bytes);
+    std::ofstream fout(path, std::ios::binary);
+    fout.write(reinterpret_cast<const char*>(&header), sizeof(Network_header));
+    fout.write(reinterpret_cast<const char*>(payload), network_bytes);
+    if (!fout) {
+        error = "could not write " + path;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,53 @@
+#ifndef EXOCET_NETWORK_FILE
+#define EXOCET_NETWORK_FILE
+
+#include "types.h"
+#include <string>
+#include <vector>
+
+//network files start with this header, the payload follows at a 64 byte offset so it can be used in place
+struct Network_header {
+    char magic[8];
+    u32 version;
+    u32 input_size;
+    u32 hidden_size;
+    u32 l1_size;
+    u32 l2_size;
+    u32 reserved;
+    u64 payload_bytes;
+    u64 checksum;
+    u8 padding[16];
+};
+
+static_assert(sizeof(Network_header) == 64, "the payload must start at a 64 byte offset");
+
+constexpr char network_magic[8] {'E', 'X', 'O', 'C', 'E', 'T', 'N', 'N'};
+constexpr u32 network_version = 1;
+
+u64 network_checksum(const unsigned char* data, u64 size);
+
+//a validated network file, mapped read-only so that every process using the same file shares its pages,
+//a file is replaced by renaming a new one over it, which leaves the mapping of the old one intact
+class Network_file {
+    unsigned char* mapping = nullptr;
+    u64 mapped_bytes = 0;
+    u64 device = 0; //identity of the mapped file, to tell whether a reload would map anything new
+    u64 inode = 0;
+    i64 modified = 0;
+    std::vector<unsigned char> buffer;
+    const unsigned char* payload_data = nullptr;
+public:
+    Network_file() = default;
+    Network_file(const Network_file&) = delete;
+    Network_file& operator=(const Network_file&) = delete;
+    ~Network_file() {close();}
+    bool open(const std::string& path, std::string& error);
+    void close();
+    const unsigned char* payload() const {return payload_data;}
+    //whether path still names the mapped file, with the size and modification time it was validated with
+    bool unchanged(const std::string& path) const;
+};
+
+bool write_network_file(const std::string& path, const unsigned char* payload, std::string& error);
+
+#endif
@@ -1,9 +1,17 @@
 #include "board.h"
 #include "bits.h"
-#include "fixed_vector.h"
+#include "kernels.h"
+#include "movelist.h"
+#include "network_file.h"
 #include "nnue.h"
-#include "simd.h"
-#include <fstream>
+#include "numa.h"
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <type_traits>
+#include <vector>
 
 #ifdef _MSC_VER
 #define INCBIN_MSVC
@@ -19,253 +27,508 @@
 #undef INCBIN_MSVC
 #endif
 
+//align the embedded net for the widest kernels whatever the base instruction set, so that the weights are used in place
+#undef INCBIN_ALIGNMENT_INDEX
+#define INCBIN_ALIGNMENT_INDEX 6
+
 INCBIN(eval, NETWORK_FILE);
 
-#ifdef SIMD
-alignas(ALIGNMENT) std::array<i16, input_size * hidden_size> input_weights;
-alignas(ALIGNMENT) std::array<i16, hidden_size> input_bias;
-alignas(ALIGNMENT) std::array<i16, hidden_dsize> hidden_weights;
-alignas(ALIGNMENT) std::array<i32, output_size> hidden_bias;
-#else
-std::array<i16, input_size * hidden_size> input_weights;
-std::array<i16, hidden_size> input_bias;
-std::array<i16, hidden_dsize> hidden_weights;
-std::array<i32, output_size> hidden_bias;
-#endif
+Net_format net_format = format_i16;
+bool small_net_enabled = false;
+
+static std::shared_ptr<Network> published_network;
+static u64 network_versions = 0;
+
+//the newest ply a side's accumulator can be brought up to date from, or -1 when it has to be rebuilt from the position
+template <int size> static int last_computed(const std::array<Accumulator<size>, 128>& stack, const std::array<Dirty_pieces, 128>& dirty, int current, int side) {
+    for (int ply = current; ply > 0; --ply) {
+        if (stack[ply].computed[side]) return ply;
+        if (dirty[ply].refresh == 1 + side) return -1;
+    }
+    return stack[0].computed[side] ? 0 : -1;
+}
+
+static int active_features(Position& position, int side, int* features) {
+    int count{};
+    u64 pieces = position.occupied();
+    const int king_square = get_lsb(position.pieces[black_king + side]);
+    while (pieces) {
+        int square = pop_lsb(pieces);
+        features[count++] = index(position.board[square], square, side, king_square);
+    }
+    return count;
+}
+
+//a ply moves one or two pieces: sub+add, sub+sub+add for captures, or two sub+add pairs for castling
+template <typename weight_type> static void apply_dirty(i16* accumulator, const weight_type* weights, const Dirty_pieces& dirty, int side, int king_square) {
+    auto sub = [&](int i) {return weights + index(dirty.sub_piece[i], dirty.sub_square[i], side, king_square) * hidden_size;};
+    auto add = [&](int i) {return weights + index(dirty.add_piece[i], dirty.add_square[i], side, king_square) * hidden_size;};
+    if (dirty.sub_count > dirty.add_count) {
+        if constexpr (std::is_same_v<weight_type, i8>) kernels->sub_sub_add_i8(accumulator, sub(0), sub(1), add(0));
+        else kernels->sub_sub_add(accumulator, sub(0), sub(1), add(0));
+        return;
+    }
+    for (int i{}; i < dirty.add_count; ++i) {
+        if constexpr (std::is_same_v<weight_type, i8>) kernels->sub_add_i8(accumulator, sub(i), add(i));
+        else kernels->sub_add(accumulator, sub(i), add(i));
+    }
+}
+
+static void apply_dirty_small(i16* accumulator, const i16* weights, const Dirty_pieces& dirty, int side, int king_square) {
+    for (int i{}; i < dirty.sub_count; ++i) {
+        const i16* feature = weights + index(dirty.sub_piece[i], dirty.sub_square[i], side, king_square) * small_hidden_size;
+        for (int j{}; j < small_hidden_size; ++j) accumulator[j] -= feature[j];
+    }
+    for (int i{}; i < dirty.add_count; ++i) {
+        const i16* feature = weights + index(dirty.add_piece[i], dirty.add_square[i], side, king_square) * small_hidden_size;
+        for (int j{}; j < small_hidden_size; ++j) accumulator[j] += feature[j];
+    }
+}
+
+void NNUE::refresh(Position& position) {
+    network = current_network();
+    refresh_side(0, position);
+    refresh_side(1, position);
+    if (network->small) {
+        refresh_small_side(0, position);
+        refresh_small_side(1, position);
+    }
+}
+
+void NNUE::refresh_side(int side, Position& position) {
+    Accumulator<hidden_size>& accumulator = accumulator_stack[current_accumulator];
+    int features[64];
+    const int count = active_features(position, side, features);
+    if (network->format == format_i8) kernels->refresh_i8(accumulator[side].data(), network->quantized->input_bias.data(), network->quantized->input_weights.data(), features, count);
+    else kernels->refresh(accumulator[side].data(), network->input_bias, network->input_weights, features, count);
+    accumulator.computed[side] = true;
+}
+
+void NNUE::refresh_small_side(int side, Position& position) {
+    Accumulator<small_hidden_size>& accumulator = small_stack[current_accumulator];
+    int features[64];
+    const int count = active_features(position, side, features);
+    accumulator[side] = network->small->input_bias;
+    for (int i{}; i < count; ++i) {
+        const i16* feature = network->small->input_weights.data() + features[i] * small_hidden_size;
+        for (int j{}; j < small_hidden_size; ++j) accumulator[side][j] += feature[j];
+    }
+    accumulator.computed[side] = true;
+}
 
-template void NNUE::update_accumulator<true>(int piece, int square, int black_king_square, int white_king_square);
-template void NNUE::update_accumulator<false>(int piece, int square, int black_king_square, int white_king_square);
+void NNUE::update_side(int side, Position& position) {
+    const int start = last_computed(accumulator_stack, dirty_stack, current_accumulator, side);
+    if (start < 0) return refresh_side(side, position);
+    //no ply since start moved this side's king across a mirror or bucket boundary, so its current square gives the same features
+    const int king_square = get_lsb(position.pieces[black_king + side]);
+    for (int ply = start + 1; ply <= current_accumulator; ++ply) {
+        accumulator_stack[ply][side] = accumulator_stack[ply - 1][side];
+        if (network->format == format_i8) apply_dirty(accumulator_stack[ply][side].data(), network->quantized->input_weights.data(), dirty_stack[ply], side, king_square);
+        else apply_dirty(accumulator_stack[ply][side].data(), network->input_weights, dirty_stack[ply], side, king_square);
+        accumulator_stack[ply].computed[side] = true;
+    }
+}
 
-template <bool add> void NNUE::update_accumulator(int piece, int square, int black_king_square, int white_king_square) {
-    Accumulator& accumulator = accumulator_stack[current_accumulator];
+void NNUE::update_small_side(int side, Position& position) {
+    const int start = last_computed(small_stack, dirty_stack, current_accumulator, side);
+    if (start < 0) return refresh_small_side(side, position);
+    const int king_square = get_lsb(position.pieces[black_king + side]);
+    for (int ply = start + 1; ply <= current_accumulator; ++ply) {
+        small_stack[ply][side] = small_stack[ply - 1][side];
+        apply_dirty_small(small_stack[ply][side].data(), network->small->input_weights.data(), dirty_stack[ply], side, king_square);
+        small_stack[ply].computed[side] = true;
+    }
+}
+
+void NNUE::update(Position& position) {
+    update_side(0, position);
+    update_side(1, position);
+}
+
+void NNUE::update_small(Position& position) {
+    update_small_side(0, position);
+    update_small_side(1, position);
+}
+
+//output layers on top of a pair of accumulators, shared by the search and the batched evaluation
+static i32 output_layers(const Network& network, const i16* us, const i16* them) {
+    if constexpr (l1_size > 0) {
+        const Dense_layers& dense = *network.dense;
+        const Layer_weights layers{dense.l1_weights.data(), dense.l1_bias.data(), dense.l2_weights.data(), dense.l2_bias.data(), dense.output_weights.data(), dense.output_bias};
+        const i16* scale = network.format == format_i8 ? network.quantized->input_scale.data() : dense.unit_scale.data();
+        return kernels->propagate(us, them, scale, layers) * 400 / (127 << layer_shift);
+    }
+    i32 output;
+    if (network.format == format_i8) {
+        //the int8 activations are the squares shifted down by 8 bits
+        const i64 dot = kernels->screlu_dot_i8(us, them, network.quantized->input_scale.data(), network.quantized->hidden_weights.data());
+        output = static_cast<i32>(dot * 256 * network.quantized->hidden_scale) + (network.hidden_bias[0] * input_quantization);
+    } else {
+        output = kernels->screlu_dot(us, them, network.hidden_weights) + (network.hidden_bias[0] * input_quantization);
+    }
+    return (output / input_quantization * 400) / input_quantization / hidden_quantization;
+}
+
+i32 NNUE::evaluate(bool side) {
+    Accumulator<hidden_size>& accumulator = accumulator_stack[current_accumulator];
+    return output_layers(*network, accumulator[side].data(), accumulator[!side].data());
+}
+
+i32 NNUE::evaluate_small(bool side) {
+    Accumulator<small_hidden_size>& accumulator = small_stack[current_accumulator];
+    i32 output = network->small->output_bias;
+    for (int i{}; i < small_hidden_size; ++i) {
+        output += screlu(accumulator[side][i]) * network->small->hidden_weights[i] + screlu(accumulator[!side][i]) * network->small->hidden_weights[small_hidden_size + i];
+    }
+    return (output / input_quantization * 400) / input_quantization / hidden_quantization;
+}
+
+Eval_position make_eval_position(Position& position) {
+    Eval_position result;
+    result.occupied = position.occupied();
+    std::memcpy(result.board, position.board, sizeof(result.board));
+    result.king_square[0] = get_lsb(position.pieces[black_king]);
+    result.king_square[1] = get_lsb(position.pieces[white_king]);
+    result.side_to_move = position.side_to_move;
+    return result;
+}
+
+static int active_features(const Eval_position& position, int side, int* features) {
+    int count{};
+    u64 pieces = position.occupied;
+    while (pieces) {
+        int square = pop_lsb(pieces);
+        features[count++] = index(position.board[square], square, side, position.king_square[side]);
+    }
+    return count;
+}
+
+i32 evaluate_position(const Eval_position& position, const Network& network) {
+    Accumulator<hidden_size> accumulator;
     for (int side{}; side < 2; ++side) {
-        const int inputs = index(piece, square, side, side ? white_king_square : black_king_square);
-#ifdef SIMD
-        const register_type* weights = reinterpret_cast<register_type*>(input_weights.data() + inputs * hidden_size);
-        const register_type* input = reinterpret_cast<register_type*>(accumulator[side].data());
-        register_type* output = reinterpret_cast<register_type*>(accumulator[side].data());
-        if constexpr (add) {
-            for (int i = 0; i < hidden_size / I16_STRIDE; i += 4) {
-                output[i + 0] = register_add_16(input[i + 0], weights[i + 0]);
-                output[i + 1] = register_add_16(input[i + 1], weights[i + 1]);
-                output[i + 2] = register_add_16(input[i + 2], weights[i + 2]);
-                output[i + 3] = register_add_16(input[i + 3], weights[i + 3]);
-            }
-        } else {
-            for (int i = 0; i < hidden_size / I16_STRIDE; i += 4) {
-                output[i + 0] = register_sub_16(input[i + 0], weights[i + 0]);
-                output[i + 1] = register_sub_16(input[i + 1], weights[i + 1]);
-                output[i + 2] = register_sub_16(input[i + 2], weights[i + 2]);
-                output[i + 3] = register_sub_16(input[i + 3], weights[i + 3]);
+        int features[64];
+        const int count = active_features(position, side, features);
+        if (network.format == format_i8) kernels->refresh_i8(accumulator[side].data(), network.quantized->input_bias.data(), network.quantized->input_weights.data(), features, count);
+        else kernels->refresh(accumulator[side].data(), network.input_bias, network.input_weights, features, count);
+    }
+    return output_layers(network, accumulator[position.side_to_move].data(), accumulator[!position.side_to_move].data());
+}
+
+i32 evaluate_position(const Eval_position& position) {
+    return evaluate_position(position, *current_network());
+}
+
+//a block's accumulators stay in the L1 and L2 caches while the rows of its features are added to them
+constexpr int batch_block = 128;
+
+//positions with the same key for a side map each of their pieces to the same feature row
+static int perspective_key(const Eval_position& position, int side) {
+    return king_bucket(position.king_square[side], !side) * 2 + !!(position.king_square[side] & 0x4);
+}
+
+static int batch_key(const Eval_position& position) {
+    return perspective_key(position, 0) * 2 * buckets + perspective_key(position, 1);
+}
+
+//positions are grouped by the king bucket and mirror of both sides, then each block adds every feature row it uses
+//to all of the accumulators that need it before loading the next row
+void evaluate_batch(const Eval_position* positions, int count, i32* evals) {
+    const std::shared_ptr<const Network> network = current_network();
+    const bool i8_weights = network->format == format_i8;
+    const i16* bias = i8_weights ? network->quantized->input_bias.data() : network->input_bias;
+    //a counting sort by key keeps each group in batch order, so that positions are still read front to back
+    constexpr int keys = 4 * buckets * buckets;
+    std::vector<int> key_starts(keys + 1);
+    for (int i{}; i < count; ++i) ++key_starts[batch_key(positions[i]) + 1];
+    std::partial_sum(key_starts.begin(), key_starts.end(), key_starts.begin());
+    std::vector<int> order(count);
+    for (int i{}; i < count; ++i) order[key_starts[batch_key(positions[i])]++] = i;
+    std::vector<Accumulator<hidden_size>> accumulators(std::min(count, batch_block));
+    //the (feature, accumulator) pairs of a block, then the accumulators regrouped by feature with a counting sort
+    std::vector<int> features(batch_block * 64);
+    std::vector<i16*> owners(batch_block * 64);
+    std::vector<i16*> targets(batch_block * 64);
+    std::vector<int> row_starts(input_size + 1);
+    std::vector<int> row_ends(input_size);
+    for (int first{}; first < count; first += batch_block) {
+        const int size = std::min(batch_block, count - first);
+        int pairs{};
+        std::fill(row_starts.begin(), row_starts.end(), 0);
+        for (int slot{}; slot < size; ++slot) {
+            const Eval_position& position = positions[order[first + slot]];
+            for (int side{}; side < 2; ++side) {
+                i16* accumulator = accumulators[slot][side].data();
+                std::copy(bias, bias + hidden_size, accumulator);
+                const int active = active_features(position, side, &features[pairs]);
+                for (int i{pairs}; i < pairs + active; ++i) {
+                    owners[i] = accumulator;
+                    ++row_starts[features[i] + 1];
+                }
+                pairs += active;
             }
         }
-#else
-        const i16* weights = input_weights.data() + inputs * hidden_size;
-        if constexpr (add) {
-            for (int i = 0; i < hidden_size; i += 4) {
-                accumulator[side][i + 0] += weights[i + 0];
-                accumulator[side][i + 1] += weights[i + 1];
-                accumulator[side][i + 2] += weights[i + 2];
-                accumulator[side][i + 3] += weights[i + 3];
-            }
-        } else {
-            for (int i = 0; i < hidden_size; i += 4) {
-                accumulator[side][i + 0] -= weights[i + 0];
-                accumulator[side][i + 1] -= weights[i + 1];
-                accumulator[side][i + 2] -= weights[i + 2];
-                accumulator[side][i + 3] -= weights[i + 3];
-            }
+        std::partial_sum(row_starts.begin(), row_starts.end(), row_starts.begin());
+        std::copy(row_starts.begin(), row_starts.end() - 1, row_ends.begin());
+        for (int i{}; i < pairs; ++i) targets[row_ends[features[i]]++] = owners[i];
+        for (int row{}; row < input_size; ++row) {
+            const int users = row_ends[row] - row_starts[row];
+            if (!users) continue;
+            if (i8_weights) kernels->add_to_each_i8(&targets[row_starts[row]], users, network->quantized->input_weights.data() + row * hidden_size);
+            else kernels->add_to_each(&targets[row_starts[row]], users, network->input_weights + row * hidden_size);
+        }
+        for (int slot{}; slot < size; ++slot) {
+            const Eval_position& position = positions[order[first + slot]];
+            evals[order[first + slot]] = output_layers(*network, accumulators[slot][position.side_to_move].data(), accumulators[slot][!position.side_to_move].data());
         }
-#endif
     }
 }
 
-template <bool add, int side> void NNUE::update_accumulator_side(int piece, int square, int black_king_square, int white_king_square) {
-    Accumulator& accumulator = accumulator_stack[current_accumulator];
-    const int inputs = index(piece, square, side, side ? white_king_square : black_king_square);
-#ifdef SIMD
-    const register_type* weights = reinterpret_cast<register_type*>(input_weights.data() + inputs * hidden_size);
-    const register_type* input = reinterpret_cast<register_type*>(accumulator[side].data());
-    register_type* output = reinterpret_cast<register_type*>(accumulator[side].data());
-    if constexpr (add) {
-        for (int i = 0; i < hidden_size / I16_STRIDE; i += 4) {
-            output[i + 0] = register_add_16(input[i + 0], weights[i + 0]);
-            output[i + 1] = register_add_16(input[i + 1], weights[i + 1]);
-            output[i + 2] = register_add_16(input[i + 2], weights[i + 2]);
-            output[i + 3] = register_add_16(input[i + 3], weights[i + 3]);
-        }
-    } else {
-        for (int i = 0; i < hidden_size / I16_STRIDE; i += 4) {
-            output[i + 0] = register_sub_16(input[i + 0], weights[i + 0]);
-            output[i + 1] = register_sub_16(input[i + 1], weights[i + 1]);
-            output[i + 2] = register_sub_16(input[i + 2], weights[i + 2]);
-            output[i + 3] = register_sub_16(input[i + 3], weights[i + 3]);
+//dense layer weights are stored output-major and regrouped here so that the 4 inputs of a chunk are adjacent for every output
+template <int input_dims, int output_dims> void load_dense_layer(const unsigned char* data, i8* weights) {
+    for (int output{}; output < output_dims; ++output) {
+        for (int input{}; input < input_dims; ++input) {
+            weights[((input / 4) * output_dims + output) * 4 + input % 4] = static_cast<i8>(data[output * input_dims + input]);
         }
     }
-#else
-    const i16* weights = input_weights.data() + inputs * hidden_size;
-    if constexpr (add) {
-        for (int i = 0; i < hidden_size; i += 4) {
-            accumulator[side][i + 0] += weights[i + 0];
-            accumulator[side][i + 1] += weights[i + 1];
-            accumulator[side][i + 2] += weights[i + 2];
-            accumulator[side][i + 3] += weights[i + 3];
-        }
+}
+
+//points straight into the source data when there is no copy to make, every section offset is a multiple of the alignment
+template <typename weight_type> static const weight_type* weight_view(const unsigned char* data, weight_type* copy, u64 count) {
+    if (!copy) return reinterpret_cast<const weight_type*>(data);
+    std::memcpy(copy, data, count * sizeof(weight_type));
+    return copy;
+}
+
+void Network::load(const unsigned char* source_data) {
+    u64 memory_index = 0;
+    data = source_data;
+    std::shared_ptr<Copied_weights> copy;
+    if (reinterpret_cast<std::uintptr_t>(data) % ALIGNMENT != 0) copy = std::make_shared<Copied_weights>();
+    input_weights = weight_view(&data[memory_index], copy ? copy->input_weights.data() : nullptr, input_size * hidden_size);
+    memory_index += input_size * hidden_size * sizeof(i16);
+    input_bias = weight_view(&data[memory_index], copy ? copy->input_bias.data() : nullptr, hidden_size);
+    memory_index += hidden_size * sizeof(i16);
+    if constexpr (l1_size > 0) {
+        auto layers = std::make_shared<Dense_layers>();
+        load_dense_layer<hidden_dsize, l1_size>(&data[memory_index], layers->l1_weights.data());
+        memory_index += l1_size * hidden_dsize;
+        std::memcpy(layers->l1_bias.data(), &data[memory_index], l1_size * sizeof(i32));
+        memory_index += l1_size * sizeof(i32);
+        load_dense_layer<l1_size, l2_size>(&data[memory_index], layers->l2_weights.data());
+        memory_index += l2_size * l1_size;
+        std::memcpy(layers->l2_bias.data(), &data[memory_index], l2_size * sizeof(i32));
+        memory_index += l2_size * sizeof(i32);
+        std::memcpy(layers->output_weights.data(), &data[memory_index], l2_size);
+        memory_index += l2_size;
+        std::memcpy(&layers->output_bias, &data[memory_index], sizeof(i32));
+        memory_index += sizeof(i32);
+        layers->unit_scale.fill(1);
+        dense = std::move(layers);
     } else {
-        for (int i = 0; i < hidden_size; i += 4) {
-            accumulator[side][i + 0] -= weights[i + 0];
-            accumulator[side][i + 1] -= weights[i + 1];
-            accumulator[side][i + 2] -= weights[i + 2];
-            accumulator[side][i + 3] -= weights[i + 3];
-        }
+        hidden_weights = weight_view(&data[memory_index], copy ? copy->hidden_weights.data() : nullptr, hidden_dsize * output_size);
+        memory_index += hidden_dsize * output_size * sizeof(i16);
+        hidden_bias = weight_view(&data[memory_index], copy ? copy->hidden_bias.data() : nullptr, output_size);
+        memory_index += output_size * sizeof(i32);
     }
-#endif
+    copied = std::move(copy);
+    quantized.reset();
+    format = net_format;
+    if (format == format_i8) quantize();
+    small.reset();
+    if (small_net_enabled) derive_small();
 }
 
-void NNUE::update_accumulator_sub_add(u64 sides, std::array<int, 2> sub, std::array<int, 2> add) {
-    Accumulator& accumulator = accumulator_stack[current_accumulator];
-    while (sides != 0) {
-        int side = pop_lsb(sides);
-#ifdef SIMD
-        const register_type* weights_sub = reinterpret_cast<register_type*>(input_weights.data() + sub[side] * hidden_size);
-        const register_type* weights_add = reinterpret_cast<register_type*>(input_weights.data() + add[side] * hidden_size);
-        const register_type* input = reinterpret_cast<register_type*>(accumulator[side].data());
-        register_type* output = reinterpret_cast<register_type*>(accumulator[side].data());
-        for (int i = 0; i < hidden_size / I16_STRIDE; i += 4) {
-            output[i + 0] = register_add_16(register_sub_16(input[i + 0], weights_sub[i + 0]), weights_add[i + 0]);
-            output[i + 1] = register_add_16(register_sub_16(input[i + 1], weights_sub[i + 1]), weights_add[i + 1]);
-            output[i + 2] = register_add_16(register_sub_16(input[i + 2], weights_sub[i + 2]), weights_add[i + 2]);
-            output[i + 3] = register_add_16(register_sub_16(input[i + 3], weights_sub[i + 3]), weights_add[i + 3]);
+//copies the weights the kernels read in the network's format into this object, so that a thread pinned to a numa node
+//can place them there, the int16 weights of an int8 net are only read for the output bias and stay shared
+void Network::replicate(std::shared_ptr<const Network> source) {
+    *this = *source;
+    if (format == format_i16) {
+        auto copy = std::make_shared<Copied_weights>();
+        std::copy_n(source->input_weights, input_size * hidden_size, copy->input_weights.begin());
+        std::copy_n(source->input_bias, hidden_size, copy->input_bias.begin());
+        input_weights = copy->input_weights.data();
+        input_bias = copy->input_bias.data();
+        if constexpr (l1_size == 0) {
+            std::copy_n(source->hidden_weights, hidden_dsize * output_size, copy->hidden_weights.begin());
+            std::copy_n(source->hidden_bias, output_size, copy->hidden_bias.begin());
+            hidden_weights = copy->hidden_weights.data();
+            hidden_bias = copy->hidden_bias.data();
         }
-#else
-        const i16* weights_sub = input_weights.data() + sub[side] * hidden_size;
-        const i16* weights_add = input_weights.data() + add[side] * hidden_size;
-        for (int i = 0; i < hidden_size; i += 4) {
-            accumulator[side][i + 0] += -weights_sub[i + 0] + weights_add[i + 0];
-            accumulator[side][i + 1] += -weights_sub[i + 1] + weights_add[i + 1];
-            accumulator[side][i + 2] += -weights_sub[i + 2] + weights_add[i + 2];
-            accumulator[side][i + 3] += -weights_sub[i + 3] + weights_add[i + 3];
+        copied = std::move(copy);
+    }
+    if (quantized && format == format_i8) quantized = std::make_shared<Quantized_weights>(*quantized);
+    if (dense) dense = std::make_shared<Dense_layers>(*dense);
+    if (small) small = std::make_shared<Small_weights>(*small);
+    origin = std::move(source);
+}
+
+static i16 divide_rounded(int value, int divisor) {
+    return static_cast<i16>(value >= 0 ? (value + divisor / 2) / divisor : -((-value + divisor / 2) / divisor));
+}
+
+void Network::quantize() {
+    auto weights = std::make_shared<Quantized_weights>();
+    //each hidden neuron gets the smallest scale that fits its weights into int8, the accumulators then hold the neuron's value divided by that scale
+    for (int neuron{}; neuron < hidden_size; ++neuron) {
+        int largest = 1;
+        for (int input{}; input < input_size; ++input) largest = std::max(largest, std::abs(static_cast<int>(input_weights[input * hidden_size + neuron])));
+        const int scale = (largest + 126) / 127;
+        weights->input_scale[neuron] = scale;
+        weights->input_bias[neuron] = divide_rounded(input_bias[neuron], scale);
+        for (int input{}; input < input_size; ++input) {
+            weights->input_weights[input * hidden_size + neuron] = divide_rounded(input_weights[input * hidden_size + neuron], scale);
         }
-#endif
     }
+    if constexpr (l1_size == 0) {
+        int largest = 1;
+        for (int i{}; i < hidden_dsize; ++i) largest = std::max(largest, std::abs(static_cast<int>(hidden_weights[i])));
+        weights->hidden_scale = (largest + 126) / 127;
+        for (int i{}; i < hidden_dsize; ++i) weights->hidden_weights[i] = divide_rounded(hidden_weights[i], weights->hidden_scale);
+    }
+    quantized = std::move(weights);
 }
 
-void NNUE::update_accumulator_sub_sub_add(u64 sides, std::array<int, 2> sub1, std::array<int, 2> sub2, std::array<int, 2> add) {
-    Accumulator& accumulator = accumulator_stack[current_accumulator];
-    while (sides != 0) {
-        int side = pop_lsb(sides);
-#ifdef SIMD
-        const register_type* weights_sub1 = reinterpret_cast<register_type*>(input_weights.data() + sub1[side] * hidden_size);
-        const register_type* weights_sub2 = reinterpret_cast<register_type*>(input_weights.data() + sub2[side] * hidden_size);
-        const register_type* weights_add = reinterpret_cast<register_type*>(input_weights.data() + add[side] * hidden_size);
-        const register_type* input = reinterpret_cast<register_type*>(accumulator[side].data());
-        register_type* output = reinterpret_cast<register_type*>(accumulator[side].data());
-        for (int i = 0; i < hidden_size / I16_STRIDE; i += 4) {
-            output[i + 0] = register_add_16(register_sub_16(register_sub_16(input[i + 0], weights_sub1[i + 0]), weights_sub2[i + 0]), weights_add[i + 0]);
-            output[i + 1] = register_add_16(register_sub_16(register_sub_16(input[i + 1], weights_sub1[i + 1]), weights_sub2[i + 1]), weights_add[i + 1]);
-            output[i + 2] = register_add_16(register_sub_16(register_sub_16(input[i + 2], weights_sub1[i + 2]), weights_sub2[i + 2]), weights_add[i + 2]);
-            output[i + 3] = register_add_16(register_sub_16(register_sub_16(input[i + 3], weights_sub1[i + 3]), weights_sub2[i + 3]), weights_add[i + 3]);
+void Network::derive_small() {
+    if constexpr (l1_size == 0) {
+        //hidden activations at the start position with white to move rank the neurons and stand in for the dropped ones
+        Position start_position;
+        std::array<std::array<i32, hidden_size>, 2> activation;
+        for (int side{}; side < 2; ++side) {
+            int features[64];
+            const int count = active_features(start_position, side, features);
+            for (int neuron{}; neuron < hidden_size; ++neuron) {
+                int sum = input_bias[neuron];
+                for (int i{}; i < count; ++i) sum += input_weights[features[i] * hidden_size + neuron];
+                activation[side][neuron] = screlu(static_cast<i16>(std::clamp(sum, 0, static_cast<int>(input_quantization))));
+            }
         }
-#else
-        const i16* weights_sub1 = input_weights.data() + sub1[side] * hidden_size;
-        const i16* weights_sub2 = input_weights.data() + sub2[side] * hidden_size;
-        const i16* weights_add = input_weights.data() + add[side] * hidden_size;
-        for (int i = 0; i < hidden_size; i += 4) {
-            accumulator[side][i + 0] += -weights_sub1[i + 0] - weights_sub2[i + 0] + weights_add[i + 0];
-            accumulator[side][i + 1] += -weights_sub1[i + 1] - weights_sub2[i + 1] + weights_add[i + 1];
-            accumulator[side][i + 2] += -weights_sub1[i + 2] - weights_sub2[i + 2] + weights_add[i + 2];
-            accumulator[side][i + 3] += -weights_sub1[i + 3] - weights_sub2[i + 3] + weights_add[i + 3];
+        std::array<int, hidden_size> neurons;
+        std::array<i64, hidden_size> importance;
+        for (int neuron{}; neuron < hidden_size; ++neuron) {
+            neurons[neuron] = neuron;
+            importance[neuron] = static_cast<i64>(std::abs(hidden_weights[neuron]) + std::abs(hidden_weights[hidden_size + neuron])) * (activation[0][neuron] + activation[1][neuron] + 1);
         }
-#endif
+        std::stable_sort(neurons.begin(), neurons.end(), [&](int a, int b) {return importance[a] > importance[b];});
+        auto weights = std::make_shared<Small_weights>();
+        weights->output_bias = hidden_bias[0] * input_quantization;
+        for (int rank{}; rank < hidden_size; ++rank) {
+            const int neuron = neurons[rank];
+            if (rank >= small_hidden_size) {
+                weights->output_bias += activation[1][neuron] * hidden_weights[neuron] + activation[0][neuron] * hidden_weights[hidden_size + neuron];
+                continue;
+            }
+            for (int input{}; input < input_size; ++input) weights->input_weights[input * small_hidden_size + rank] = input_weights[input * hidden_size + neuron];
+            weights->input_bias[rank] = input_bias[neuron];
+            weights->hidden_weights[rank] = hidden_weights[neuron];
+            weights->hidden_weights[small_hidden_size + rank] = hidden_weights[hidden_size + neuron];
+        }
+        small = std::move(weights);
     }
 }
 
-void NNUE::refresh(Position& position) {
-    Accumulator &accumulator = accumulator_stack[current_accumulator];
-    accumulator.clear();
-    u64 pieces = position.occupied;
-    const int black_king_square = get_lsb(position.pieces[black_king]);
-    const int white_king_square = get_lsb(position.pieces[white_king]);
-    while (pieces) {
-        int square = pop_lsb(pieces);
-        int piece = position.board[square];
-        update_accumulator<true>(piece, square, black_king_square, white_king_square);
-    }
+//a replica per numa node, rebuilt by the first pinned thread to see a newer published network
+static std::shared_ptr<const Network> node_replica(std::shared_ptr<const Network> network, int node) {
+    static std::mutex replicas_mutex;
+    static std::vector<std::shared_ptr<const Network>> replicas(numa_nodes().size());
+    std::lock_guard<std::mutex> lock(replicas_mutex);
+    const std::shared_ptr<const Network>& replica = replicas[node];
+    if (replica && replica->origin == network) return replica;
+    auto copy = std::make_shared<Network>();
+    copy->replicate(std::move(network));
+    replicas[node] = copy;
+    return copy;
 }
 
-void NNUE::refresh_side(int side, Position& position) {
-    Accumulator &accumulator = accumulator_stack[current_accumulator];
-    accumulator.clear_side(side);
-    u64 pieces = position.occupied;
-    const int black_king_square = get_lsb(position.pieces[black_king]);
-    const int white_king_square = get_lsb(position.pieces[white_king]);
-    while (pieces) {
-        int square = pop_lsb(pieces);
-        int piece = position.board[square];
-        if (!side) {
-            update_accumulator_side<true, 0>(piece, square, black_king_square, white_king_square);
-        } else {
-            update_accumulator_side<true, 1>(piece, square, black_king_square, white_king_square);
-        }
-    }
+std::shared_ptr<const Network> current_network() {
+    std::shared_ptr<const Network> network = std::atomic_load(&published_network);
+    const int node = bound_numa_node();
+    if (node < 0 || numa_nodes().size() < 2 || !network) return network;
+    return node_replica(std::move(network), node);
 }
 
-i32 NNUE::evaluate(bool side) {
-    Accumulator &accumulator = accumulator_stack[current_accumulator];
-#ifdef SIMD
-    const register_type screlu_min{};
-    const register_type screlu_max = register_set_16(input_quantization);
-    register_type res{};
-    const register_type* accumulator_us = reinterpret_cast<register_type*>(accumulator[side].data());
-    const register_type* accumulator_them = reinterpret_cast<register_type*>(accumulator[!side].data());
-    const register_type* weights = reinterpret_cast<register_type*>(hidden_weights.data());
-    for (int i = 0; i < hidden_size / I16_STRIDE; ++i) {
-        const register_type clipped = register_min_16(register_max_16(accumulator_us[i], screlu_min), screlu_max);
-        res = register_add_32(res, register_madd_16(register_mul_16(clipped, clipped), weights[i]));
-    }
-    for (int i = 0; i < hidden_size / I16_STRIDE; ++i) {
-        const register_type clipped = register_min_16(register_max_16(accumulator_them[i], screlu_min), screlu_max);
-        res = register_add_32(res, register_madd_16(register_mul_16(clipped, clipped), weights[i + hidden_size / I16_STRIDE]));
+//searches keep the network they started with, the old one is freed when the last of them finishes
+static void publish(std::shared_ptr<Network> network) {
+    network->version = ++network_versions;
+    std::atomic_store(&published_network, std::move(network));
+}
+
+bool load_default() {
+    if (geval_size != network_bytes) {
+        std::cout << "info string error embedded net has " << geval_size << " bytes, expected " << network_bytes << std::endl;
+        return false;
     }
-    i32 output = register_sum_32(res) + (hidden_bias[0] * input_quantization);
-#else
-    i32 output = hidden_bias[0] * input_quantization;
-    for (int i = 0; i < hidden_size; ++i) {
-        output += screlu(accumulator[side][i]) * hidden_weights[i];
+    auto network = std::make_shared<Network>();
+    network->source = "<default>";
+    network->load(geval_data);
+    publish(std::move(network));
+    return true;
+}
+
+//a rejected file leaves the current net loaded
+bool load_from_file(const std::string& name) {
+    auto network = std::make_shared<Network>();
+    network->file = std::make_shared<Network_file>();
+    std::string error;
+    if (!network->file->open(name, error)) {
+        std::cout << "info string error rejected net " << name << ": " << error << std::endl;
+        return false;
     }
-    for (int i = 0; i < hidden_size; ++i) {
-        output += screlu(accumulator[!side][i]) * hidden_weights[hidden_size + i];
+    network->source = name;
+    network->load(network->file->payload());
+    publish(network);
+    std::cout << "info string loaded net version " << network->version << " from " << name << std::endl;
+    return true;
+}
+
+//loads the current source again, picking up a net file that was replaced on disk, the new file is mapped and
+//validated like any other and the current net stays loaded if it is rejected
+bool reload_network() {
+    const std::shared_ptr<const Network> network = current_network();
+    if (!network || network->source == "<default>") return load_default();
+    if (network->file && network->file->unchanged(network->source)) {
+        std::cout << "info string net " << network->source << " is unchanged, keeping version " << network->version << std::endl;
+        return true;
     }
-#endif
-    return (output / input_quantization * 400) / input_quantization / hidden_quantization;
+    return load_from_file(network->source);
 }
 
-void load_default() {
-    uint64_t memory_index = 0;
-    std::memcpy(input_weights.data(), &geval_data[memory_index], input_size * hidden_size * sizeof(i16));
-    memory_index += input_size * hidden_size * sizeof(i16);
-    std::memcpy(input_bias.data(), &geval_data[memory_index], hidden_size * sizeof(i16));
-    memory_index += hidden_size * sizeof(i16);
-    std::memcpy(hidden_weights.data(), &geval_data[memory_index], hidden_dsize * output_size * sizeof(i16));
-    memory_index += hidden_dsize * output_size * sizeof(i16);
-    std::memcpy(hidden_bias.data(), &geval_data[memory_index], output_size * sizeof(i32));
-    memory_index += output_size * sizeof(i32);
-}
-
-void load_from_file(std::string& name) {
-    std::ifstream fin(name, std::ios::binary);
-    fin.read(reinterpret_cast<char*>(input_weights.data()), input_size * hidden_size * sizeof(i16));
-    fin.read(reinterpret_cast<char*>(input_bias.data()), hidden_size * sizeof(i16));
-    fin.read(reinterpret_cast<char*>(hidden_weights.data()), hidden_dsize * output_size * sizeof(i16));
-    fin.read(reinterpret_cast<char*>(hidden_bias.data()), output_size * sizeof(i32));
-    if (!fin) {
-        std::cout << "info string error could not load net from " << name << std::endl;
-        load_default();
-    } else {
-        std::cout << "info string loaded net from " << name << std::endl;
+bool export_network(const std::string& name) {
+    const std::shared_ptr<const Network> network = current_network();
+    std::string error;
+    if (!network || !write_network_file(name, network->data, error)) {
+        std::cout << "info string error could not export net: " << (network ? error : "no net loaded") << std::endl;
+        return false;
     }
+    std::cout << "info string exported net to " << name << std::endl;
+    return true;
+}
+
+//a running search keeps the network it started with, so the new format is published as a copy sharing the current weights
+void set_net_format(Net_format format) {
+    net_format = format;
+    const std::shared_ptr<const Network> current = std::atomic_load(&published_network);
+    if (!current || current->format == format) return;
+    auto network = std::make_shared<Network>(*current);
+    network->format = format;
+    if (format == format_i8 && !network->quantized) network->quantize();
+    publish(std::move(network));
 }
 
-void nnue_init() {
-    load_default();
-}
\ No newline at end of file
+//the small net is derived from the single layer architecture's output weights
+bool set_small_net(bool enabled) {
+    if (enabled && l1_size > 0) return false;
+    small_net_enabled = enabled;
+    const std::shared_ptr<const Network> current = std::atomic_load(&published_network);
+    if (!current || !current->small == !enabled) return true;
+    //published like a format change, so that a running search never sees the small weights appear or go
+    auto network = std::make_shared<Network>(*current);
+    if (enabled) network->derive_small();
+    else network->small.reset();
+    publish(std::move(network));
+    return true;
+}
+
+//a build whose dense layer sizes the embedded net was not trained for has nothing to evaluate with
+bool nnue_init() {
+    return load_default();
+}
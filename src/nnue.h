@@ -1,25 +1,90 @@
 #ifndef EXOCET_NNUE
 #define EXOCET_NNUE
 
+#include "bits.h"
+#include "nnue_arch.h"
 #include "simd.h"
 #include "types.h"
 #include <array>
 #include <algorithm>
 #include <cstring>
+#include <memory>
 #include <string>
 
-constexpr int buckets = 1;
-constexpr int input_size = 12 * 64 * buckets;
-constexpr int hidden_size = 64;
-constexpr int hidden_dsize = hidden_size * 2;
-constexpr int output_size = 1;
-constexpr int input_quantization = 181;
-constexpr int hidden_quantization = 128;
+enum Net_format {
+    format_i16,
+    format_i8
+};
+
+extern Net_format net_format; //the format of the published net and of nets loaded later
+extern bool small_net_enabled; //whether the published net and nets loaded later carry the small net
+
+class Network_file;
+
+//copies backing a network's views when its source data is misaligned, or when a numa node needs its own
+struct Copied_weights {
+    alignas(ALIGNMENT) std::array<i16, input_size * hidden_size> input_weights;
+    alignas(ALIGNMENT) std::array<i16, hidden_size> input_bias;
+    alignas(ALIGNMENT) std::array<i16, hidden_dsize> hidden_weights;
+    alignas(ALIGNMENT) std::array<i32, output_size> hidden_bias;
+};
+
+//int8 copies of the weights, quantized per hidden neuron
+struct Quantized_weights {
+    alignas(ALIGNMENT) std::array<i8, input_size * hidden_size> input_weights;
+    alignas(ALIGNMENT) std::array<i16, hidden_size> input_bias;
+    alignas(ALIGNMENT) std::array<i16, hidden_size> input_scale;
+    alignas(ALIGNMENT) std::array<i8, hidden_dsize> hidden_weights;
+    i32 hidden_scale{};
+};
+
+//dense layers of the multi-layer architecture, regrouped by 4-input chunk
+struct Dense_layers {
+    alignas(ALIGNMENT) std::array<i8, l1_size * hidden_dsize> l1_weights;
+    alignas(ALIGNMENT) std::array<i32, l1_size> l1_bias;
+    alignas(ALIGNMENT) std::array<i8, l2_size * l1_size> l2_weights;
+    alignas(ALIGNMENT) std::array<i32, l2_size> l2_bias;
+    alignas(ALIGNMENT) std::array<i8, l2_size> output_weights;
+    i32 output_bias{};
+    alignas(ALIGNMENT) std::array<i16, hidden_size> unit_scale;
+};
+
+//the small net keeps the most important hidden neurons, the dropped ones are folded into its bias at the start position
+struct Small_weights {
+    alignas(ALIGNMENT) std::array<i16, input_size * small_hidden_size> input_weights;
+    alignas(ALIGNMENT) std::array<i16, small_hidden_size> input_bias;
+    alignas(ALIGNMENT) std::array<i16, small_hidden_size * 2> hidden_weights;
+    i32 output_bias{};
+};
+
+//one loaded set of weights, published as a whole so that a reload never changes the weights under a running search,
+//the parts a format or architecture does not use are never allocated and copies share the parts they do not change
+struct Network {
+    u64 version{};
+    std::string source;
+    const unsigned char* data = nullptr;
+    std::shared_ptr<Network_file> file; //shared by the copies a new format or a numa node replica makes
+    std::shared_ptr<const Network> origin; //the published network a numa node replica was copied from
+
+    //views of the weights, pointing into the source data when it is aligned for the kernels
+    const i16* input_weights = nullptr;
+    const i16* input_bias = nullptr;
+    const i16* hidden_weights = nullptr;
+    const i32* hidden_bias = nullptr;
+    std::shared_ptr<const Copied_weights> copied; //null while the views point into the source data
+
+    //the format searches using this net evaluate it in, changing it publishes a new net
+    Net_format format = format_i16;
 
-extern std::array<i16, input_size * hidden_size> input_weights;
-extern std::array<i16, hidden_size> input_bias;
-extern std::array<i16, hidden_dsize> hidden_weights;
-extern std::array<i32, output_size> hidden_bias;
+    std::shared_ptr<const Quantized_weights> quantized; //null until the int8 format is first used with this net
+    std::shared_ptr<const Dense_layers> dense; //null in the single layer architecture
+    std::shared_ptr<const Small_weights> small; //null until the small net is enabled
+
+    void load(const unsigned char* source_data);
+    void replicate(std::shared_ptr<const Network> source);
+    void quantize();
+    void derive_small();
+};
 
 const int king_buckets[64] {
     0, 0, 1, 1, 1, 1, 0, 0,
@@ -57,24 +122,31 @@ static inline i16 screlu(i16 input) {
     return clipped * clipped;
 }
 
-struct Accumulator {
-#ifdef SIMD
-    alignas(ALIGNMENT) std::array<i16, hidden_size> black;
-    alignas(ALIGNMENT) std::array<i16, hidden_size> white;
-#else
-    std::array<i16, hidden_size> black;
-    std::array<i16, hidden_size> white;
-#endif
-    std::array<i16, hidden_size>& operator[](bool side) {
+template <int size> struct Accumulator {
+    alignas(ALIGNMENT) std::array<i16, size> black;
+    alignas(ALIGNMENT) std::array<i16, size> white;
+    bool computed[2]{};
+    std::array<i16, size>& operator[](bool side) {
         return side ? white : black;
     }
-    inline void clear() {
-        white = input_bias;
-        black = input_bias;
+};
+
+//pieces moved by one ply, recorded once by make_move and replayed lazily into the accumulators of both nets
+struct Dirty_pieces {
+    int sub_count;
+    int add_count;
+    int sub_piece[2];
+    int sub_square[2];
+    int add_piece[2];
+    int add_square[2];
+    int refresh; //1 + the side whose king changed feature mirror or bucket, 0 for none
+    inline void sub(int piece, int square) {
+        sub_piece[sub_count] = piece;
+        sub_square[sub_count++] = square;
     }
-    inline void clear_side(int side) {
-        if (side) white = input_bias;
-        else black = input_bias;
+    inline void add(int piece, int square) {
+        add_piece[add_count] = piece;
+        add_square[add_count++] = square;
     }
 };
 
@@ -82,16 +154,23 @@ class Position;
 
 class NNUE {
     i32 current_accumulator = 0;
-    std::array<Accumulator, 128> accumulator_stack;
+    std::array<Accumulator<hidden_size>, 128> accumulator_stack;
+    std::array<Accumulator<small_hidden_size>, 128> small_stack;
+    std::array<Dirty_pieces, 128> dirty_stack;
+    std::shared_ptr<const Network> network; //held for the lifetime of a search, replaced by the next full refresh
+    void refresh_side(int side, Position& position);
+    void refresh_small_side(int side, Position& position);
+    void update_side(int side, Position& position);
+    void update_small_side(int side, Position& position);
 public:
-    NNUE() {
-        for (int i{}; i < 128; ++i) {
-            accumulator_stack[i] = Accumulator();
-        }
-    }
-    inline void push() {
-        accumulator_stack[current_accumulator + 1] = accumulator_stack[current_accumulator];
+    //the accumulators of a new ply are only computed once an evaluation needs them
+    inline Dirty_pieces& push() {
         ++current_accumulator;
+        accumulator_stack[current_accumulator].computed[0] = accumulator_stack[current_accumulator].computed[1] = false;
+        small_stack[current_accumulator].computed[0] = small_stack[current_accumulator].computed[1] = false;
+        Dirty_pieces& dirty = dirty_stack[current_accumulator];
+        dirty.sub_count = dirty.add_count = dirty.refresh = 0;
+        return dirty;
     }
     inline void pop() { 
         --current_accumulator; 
@@ -99,17 +178,46 @@ public:
     inline void reset_accumulators() { 
         current_accumulator = 0;
     }
-    void refresh(Position& position);
-    void refresh_side(int side, Position& position);
-    template <bool add> void update_accumulator(int piece, int square, int black_king_square, int white_king_square);
-    template <bool add, int side> void update_accumulator_side(int piece, int square, int black_king_square, int white_king_square);
-    void update_accumulator_sub_add(u64 sides, std::array<int, 2> sub, std::array<int, 2> add);
-    void update_accumulator_sub_sub_add(u64 sides, std::array<int, 2> sub1, std::array<int, 2> sub2, std::array<int, 2> add);
+    void refresh(Position& position); //also picks up the latest published network
+    inline u64 network_tag() const {return network->version;}
+    inline bool small_net() const {return network->small != nullptr;}
+    //starts loading the weight rows of features an upcoming move will change
+    inline void prefetch_rows(const int* features, int count) const {
+        const bool i8_weights = network->format == format_i8;
+        const char* weights = i8_weights ? reinterpret_cast<const char*>(network->quantized->input_weights.data()) : reinterpret_cast<const char*>(network->input_weights);
+        const int row_bytes = hidden_size * (i8_weights ? sizeof(i8) : sizeof(i16));
+        for (int i{}; i < count; ++i) {
+            for (int offset{}; offset < row_bytes; offset += 64) prefetch(weights + features[i] * row_bytes + offset);
+        }
+    }
+    void update(Position& position);
+    void update_small(Position& position);
     i32 evaluate(bool side);
+    i32 evaluate_small(bool side);
 };
 
-void load_default();
-void load_from_file(std::string& name);
-void nnue_init();
+//the part of a position the network reads, for evaluating positions outside a search
+struct Eval_position {
+    u64 occupied;
+    u8 board[64];
+    u8 king_square[2];
+    bool side_to_move;
+};
+
+Eval_position make_eval_position(Position& position);
+i32 evaluate_position(const Eval_position& position);
+//with a network that need not be published, such as a copy in another format
+i32 evaluate_position(const Eval_position& position, const Network& network);
+//positions sharing king buckets share the loading of their feature rows, whatever order they come in
+void evaluate_batch(const Eval_position* positions, int count, i32* evals);
+
+std::shared_ptr<const Network> current_network();
+bool load_default();
+bool load_from_file(const std::string& name);
+bool reload_network();
+bool export_network(const std::string& name);
+void set_net_format(Net_format format);
+bool set_small_net(bool enabled);
+bool nnue_init();
 
 #endif
\ No newline at end of file
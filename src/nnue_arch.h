@@ -0,0 +1,32 @@
+#ifndef EXOCET_NNUE_ARCH
+#define EXOCET_NNUE_ARCH
+
+//sizes of the dense layers between the feature transformer and the output, 0 for the single layer architecture
+#ifndef L1_SIZE
+#define L1_SIZE 0
+#endif
+#ifndef L2_SIZE
+#define L2_SIZE 0
+#endif
+
+constexpr int buckets = 1;
+constexpr int input_size = 12 * 64 * buckets;
+constexpr int hidden_size = 64;
+constexpr int hidden_dsize = hidden_size * 2;
+constexpr int output_size = 1;
+constexpr int input_quantization = 181;
+constexpr int hidden_quantization = 128;
+
+constexpr int small_hidden_size = 16; //hidden neurons kept for the small net
+
+constexpr int l1_size = L1_SIZE;
+constexpr int l2_size = L2_SIZE;
+constexpr int layer_shift = 6; //dense layer weights are scaled by 2^layer_shift, activations are u8 in [0, 127]
+
+static_assert((l1_size == 0) == (l2_size == 0), "both dense layers are needed for the multi-layer architecture");
+static_assert(l1_size % 16 == 0 && l2_size % 16 == 0, "dense layer outputs must fill whole registers");
+
+constexpr unsigned long long network_bytes = input_size * hidden_size * 2 + hidden_size * 2
+    + (l1_size ? l1_size * hidden_dsize + l1_size * 4 + l2_size * l1_size + l2_size * 4 + l2_size + 4 : hidden_dsize * output_size * 2 + output_size * 4);
+
+#endif
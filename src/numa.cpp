@@ -0,0 +1,86 @@
+#include "numa.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+static thread_local int bound_node = -1;
+
+//parses a kernel cpu list such as "0-3,8-11"
+static std::vector<int> parse_cpu_list(const std::string& list) {
+    std::vector<int> cpus;
+    std::istringstream parser(list);
+    std::string range;
+    while (std::getline(parser, range, ',')) {
+        if (range.empty() || range == "\n") continue;
+        const auto dash = range.find('-');
+        const int first = std::stoi(range.substr(0, dash));
+        const int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+        for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+static std::vector<Numa_node> detect_nodes() {
+    std::vector<Numa_node> nodes;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator("/sys/devices/system/node", error)) {
+        const std::string name = entry.path().filename().string();
+        if (name.rfind("node", 0) != 0 || name.size() == 4 || !std::all_of(name.begin() + 4, name.end(), ::isdigit)) continue;
+        std::ifstream fin(entry.path() / "cpulist");
+        std::string list;
+        std::getline(fin, list);
+        std::vector<int> cpus = parse_cpu_list(list);
+        if (!cpus.empty()) nodes.push_back({std::stoi(name.substr(4)), std::move(cpus)});
+    }
+    std::sort(nodes.begin(), nodes.end(), [](const Numa_node& a, const Numa_node& b) {return a.id < b.id;});
+    if (nodes.empty()) {
+        Numa_node all{0, {}};
+        for (int cpu{}; cpu < static_cast<int>(std::max(1u, std::thread::hardware_concurrency())); ++cpu) all.cpus.push_back(cpu);
+        nodes.push_back(all);
+    }
+    return nodes;
+}
+
+const std::vector<Numa_node>& numa_nodes() {
+    static const std::vector<Numa_node> nodes = detect_nodes();
+    return nodes;
+}
+
+bool bind_to_numa_node(int node) {
+    const std::vector<Numa_node>& nodes = numa_nodes();
+    if (node < 0 || node >= static_cast<int>(nodes.size())) return false;
+#ifdef __linux__
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    for (int cpu : nodes[node].cpus) {
+        if (cpu < CPU_SETSIZE) CPU_SET(cpu, &mask);
+    }
+    if (sched_setaffinity(0, sizeof(mask), &mask) != 0) return false;
+    bound_node = node;
+    return true;
+#else
+    return false;
+#endif
+}
+
+int bound_numa_node() {
+    return bound_node;
+}
+
+int current_numa_node() {
+#ifdef __linux__
+    const int cpu = sched_getcpu();
+    const std::vector<Numa_node>& nodes = numa_nodes();
+    for (int node{}; node < static_cast<int>(nodes.size()); ++node) {
+        if (std::find(nodes[node].cpus.begin(), nodes[node].cpus.end(), cpu) != nodes[node].cpus.end()) return node;
+    }
+#endif
+    return 0;
+}
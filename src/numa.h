@@ -0,0 +1,23 @@
+#ifndef EXOCET_NUMA
+#define EXOCET_NUMA
+
+#include <vector>
+
+struct Numa_node {
+    int id;
+    std::vector<int> cpus;
+};
+
+//memory nodes from /sys/devices/system/node, a single node holding every cpu where that is unavailable
+const std::vector<Numa_node>& numa_nodes();
+
+//pins the calling thread to the cpus of one node, memory it touches first is then allocated on that node
+bool bind_to_numa_node(int node);
+
+//index into numa_nodes() of the node the calling thread is pinned to, -1 when it is not pinned
+int bound_numa_node();
+
+//index into numa_nodes() of the node whose cpu the calling thread is running on, 0 when that is unknown
+int current_numa_node();
+
+#endif
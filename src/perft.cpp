@@ -1,37 +1,31 @@
 #include "bits.h"
 #include "perft.h"
+#include <algorithm>
+#include <bitset>
 #include <cassert>
+#include <iostream>
+#include <random>
 
-u64 perft(Position& position, int depth) {
+template <bool copy> u64 perft(Position& position, int depth) {
     if (depth == 0) {
         return 1;
     }
-    /*if (depth == 1) { //bulk counting
-        u64 total{};
-        Movelist movelist;
-        if (position.side_to_move) position.generate_stage<all, true>(movelist);
-        else position.generate_stage<all, false>(movelist);
-        for (int i{}; i<movelist.size(); ++i) {
-            if (position.is_legal(movelist[i])) {
-                ++total;
-            }
-        }
-        return total;
-    }*/
     u64 total{};
     Movelist movelist;
     position.generate_stage<all>(movelist);
+    if (depth == 1) return movelist.size(); //bulk counting, every generated move is legal
     for (int i{}; i<movelist.size(); ++i) {
-        if (position.is_legal(movelist[i])) {
-            position.make_move<false>(movelist[i]);
-            assert(!position.attacks_to(get_lsb(position.pieces[black_king + !position.side_to_move]), position.occupied, position.side_to_move));
-            total += perft(position, depth - 1);
-            position.undo_move<false>(movelist[i]);
-        }
+        position.play<false, copy>(movelist[i]);
+        assert(!position.attacks_to(get_lsb(position.pieces[black_king + !position.side_to_move]), position.occupied(), position.side_to_move));
+        total += perft<copy>(position, depth - 1);
+        position.take_back<false, copy>(movelist[i]);
     }
     return total;
 }
 
+template u64 perft<false>(Position& position, int depth);
+template u64 perft<true>(Position& position, int depth);
+
 u64 perft_split(Position& position, int depth, std::vector<std::pair<Move, int>>& list) {
     if (depth == 0) {
         return 1;
@@ -40,15 +34,115 @@ u64 perft_split(Position& position, int depth, std::vector<std::pair<Move, int>>
         Movelist movelist;
         position.generate_stage<all>(movelist);
         for (int i{}; i < movelist.size(); ++i) {
-            if (position.is_legal(movelist[i])) {
-                position.make_move<false>(movelist[i]);
-                assert(!position.attacks_to(get_lsb(position.pieces[black_king + !position.side_to_move]), position.occupied, position.side_to_move));
-                int result = perft(position, depth - 1);
-                list.push_back({movelist[i], result});
-                total += result;
-                position.undo_move<false>(movelist[i]);
-            }
+            position.play(movelist[i]);
+            assert(!position.attacks_to(get_lsb(position.pieces[black_king + !position.side_to_move]), position.occupied(), position.side_to_move));
+            int result = perft(position, depth - 1);
+            list.push_back({movelist[i], result});
+            total += result;
+            position.take_back(movelist[i]);
         }
         return total;
     }
 }
+
+//walks the perft tree comparing gives_check with making the move and testing for check at every ply,
+//the checks are counted at the leaves only, as in the published perft tables
+u64 perft_checks(Position& position, int depth, u64& checks, u64& mismatches) {
+    if (depth == 0) {
+        return 1;
+    }
+    u64 total{};
+    Movelist movelist;
+    position.generate_stage<all>(movelist);
+    for (int i{}; i < movelist.size(); ++i) {
+        const bool predicted = position.gives_check(movelist[i]);
+        position.play(movelist[i]);
+        const bool actual = position.check();
+        if (depth == 1) checks += actual;
+        if (predicted != actual && ++mismatches <= 10) {
+            position.take_back(movelist[i]);
+            std::cout << "gives_check " << predicted << " for " << movelist[i] << " in\n" << position;
+            position.play(movelist[i]);
+        }
+        total += perft_checks(position, depth - 1, checks, mismatches);
+        position.take_back(movelist[i]);
+    }
+    return total;
+}
+
+//random playouts from the position, at every ply comparing is_pseudo_legal and is_legal with the generated moves on the legal moves,
+//the moves of the ply before as a stale hash move or killer would be, and random moves, returns the number of pairs tested
+u64 fuzz_legality(Position& position, u64 pairs, u64 seed, u64& mismatches) {
+    std::mt19937_64 random(seed);
+    std::bitset<65536> legal;
+    Movelist movelist;
+    Movelist previous;
+    u64 tested{};
+    while (tested < pairs) {
+        Position game = position;
+        previous.clear();
+        for (int plies{}; plies < 200 && tested < pairs; ++plies) {
+            game.generate_stage<all>(movelist);
+            legal.reset();
+            for (int i{}; i < movelist.size(); ++i) legal.set(movelist[i].data);
+            const auto test = [&] (Move move) {
+                const bool predicted = game.is_pseudo_legal(move) && game.is_legal(move);
+                if (predicted != legal[move.data] && ++mismatches <= 10) std::cout << "legality " << predicted << " for " << move << " flag " << move.flag() << " in\n" << game;
+                ++tested;
+            };
+            for (int i{}; i < movelist.size(); ++i) test(movelist[i]);
+            for (int i{}; i < previous.size(); ++i) test(previous[i]);
+            const u64 own_pieces = game.colors[game.side_to_move];
+            for (int i{}; i < 64; ++i) {
+                test(Move{static_cast<int>(random() & 63), static_cast<int>(random() & 63), static_cast<int>(random() & 7)});
+                //from a piece of the side to move, so that most tests reach the piece rules
+                u64 from = own_pieces;
+                for (int skip = static_cast<int>(random() % popcount(own_pieces)); skip > 0; --skip) from &= from - 1;
+                test(Move{get_lsb(from), static_cast<int>(random() & 63), random() & 3 ? none : static_cast<int>(random() & 7)});
+            }
+            if (!movelist.size() || game.states[game.ply].halfmove_clock >= 100) break;
+            previous = movelist;
+            game.make_move(movelist[random() % movelist.size()]);
+        }
+    }
+    return tested;
+}
+
+//random playouts of mostly quiet piece moves that often step back into an earlier position, at every ply comparing
+//upcoming_repetition with making each legal move and looking for the key in the history, returns the number of positions tested
+u64 check_repetitions(Position& position, u64 count, u64 seed, u64& found, u64& missed, u64& extra) {
+    std::mt19937_64 random(seed);
+    Movelist movelist;
+    Movelist repeating;
+    u64 tested{};
+    while (tested < count) {
+        Position game = position;
+        for (int plies{}; plies < 200 && tested < count; ++plies) {
+            game.generate_stage<all>(movelist);
+            if (!movelist.size()) break;
+            repeating.clear();
+            for (int i{}; i < movelist.size(); ++i) {
+                game.make_move(movelist[i]);
+                const int end = std::min(static_cast<int>(game.state().halfmove_clock), game.ply);
+                for (int back{4}; back <= end; back += 2) {
+                    if (game.states[game.ply - back].key == game.key()) {
+                        repeating.add(movelist[i]);
+                        break;
+                    }
+                }
+                game.undo_move(movelist[i]);
+            }
+            const bool predicted = game.upcoming_repetition(3);
+            const bool reached = repeating.size();
+            found += predicted && reached;
+            if (reached && !predicted && ++missed <= 10) std::cout << "missed repetition in\n" << game;
+            extra += predicted && !reached; //the move back exists but is not legal now
+            ++tested;
+            Move move = movelist[random() % movelist.size()];
+            if (reached && random() % 4) move = repeating[random() % repeating.size()];
+            else for (int tries{}; tries < 8 && (!(game.board[move.start()] >> 1) || game.board[move.end()] != empty_square); ++tries) move = movelist[random() % movelist.size()];
+            game.make_move(move);
+        }
+    }
+    return tested;
+}
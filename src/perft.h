@@ -6,7 +6,10 @@
 #include "types.h"
 #include <vector>
 
-u64 perft(Position& position, int depth);
+template <bool copy = copy_make> u64 perft(Position& position, int depth);
 u64 perft_split(Position& position, int depth, std::vector<std::pair<Move, int>>& list);
+u64 perft_checks(Position& position, int depth, u64& checks, u64& mismatches);
+u64 fuzz_legality(Position& position, u64 pairs, u64 seed, u64& mismatches);
+u64 check_repetitions(Position& position, u64 count, u64 seed, u64& found, u64& missed, u64& extra);
 
 #endif
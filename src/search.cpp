@@ -1,10 +1,33 @@
 #include "search.h"
 #include "uci.h"
 
+//the small net is trusted only this far beyond the bound, above its worst error over the bench positions
+constexpr int small_net_margin = 600;
+
+//prefetches the weight rows of the move prefetch_distance - 1 places ahead, and of every move up to it on the first call
+static inline void prefetch_moves(Position& position, Search_data& sd, Movelist& movelist, int i) {
+    if (!sd.prefetch_distance) return;
+    const int first = i ? i + sd.prefetch_distance - 1 : 0;
+    const int last = std::min(i + sd.prefetch_distance, movelist.size());
+    for (int move = first; move < last; ++move) {
+        int features[4];
+        for (int side{}; side < 2; ++side) sd.nnue->prefetch_rows(features, position.move_features(movelist[move], side, features));
+    }
+}
+
 int qsearch(Position& position, Search_stack* ss, Search_data& sd, int alpha, int beta) {
     if ((*sd.timer).stopped() || (!(sd.nodes & 4095) && (*sd.timer).check(sd.nodes, 0))) return 0;
+    if (position.insufficient_material()) return 0;
     bool in_check = position.check();
-    int static_eval = position.static_eval(*sd.nnue);
+    int static_eval;
+    if (!sd.eval_cache.probe(position.key(), static_eval)) {
+        if (sd.nnue->small_net() && !in_check) {
+            const int small_eval = position.small_eval(*sd.nnue);
+            if (small_eval >= beta + small_net_margin) return small_eval;
+        }
+        static_eval = position.static_eval(*sd.nnue);
+        sd.eval_cache.store(position.key(), static_eval);
+    }
     int score = -20001;
     int best_score = -20001;
     if (!in_check) { //stand pat
@@ -21,15 +44,14 @@ int qsearch(Position& position, Search_stack* ss, Search_data& sd, int alpha, in
         position.generate_stage<noisy>(movelist);
     }
     for (int i{}; i < movelist.size(); ++i) {
-        if (!position.is_legal(movelist[i])) continue;
-        position.make_move<true>(movelist[i], sd.nnue);
+        prefetch_moves(position, sd, movelist, i);
+        position.play<true>(movelist[i], sd.nnue);
         ss->move = movelist[i];
-        bool gives_check = position.check();
         ++sd.nodes;
         ++legal_moves;
         (ss + 1)->ply = ss->ply + 1;
         score = -qsearch(position, ss + 1, sd, -beta, -alpha);
-        position.undo_move<true>(movelist[i], sd.nnue);
+        position.take_back<true>(movelist[i], sd.nnue);
         if ((*sd.timer).stopped()) return 0;
         if (score > best_score) {
             best_score = score;
@@ -56,10 +78,18 @@ int search(Position& position, Search_stack* ss, Search_data& sd, int depth, int
         return qsearch(position, ss, sd, alpha, beta);
     }
     if (depth == 1 && is_pv) sd.pv_table[ss->ply + 1][0] = Move{};
-    if (position.draw(ss->ply > 2 ? 1 : 2)) {
+    if (position.draw(ss->ply > 2 ? 1 : 2) || (!is_root && position.insufficient_material())) {
         sd.pv_table[ss->ply][0] = Move{};
         return 0;
     }
+    //the side to move can step back into an earlier position, so it will not settle for less than a draw
+    if (!is_root && alpha < 0 && position.upcoming_repetition(ss->ply)) {
+        alpha = 0;
+        if (alpha >= beta) {
+            sd.pv_table[ss->ply][0] = Move{};
+            return alpha;
+        }
+    }
     bool in_check = position.check();
     int score = -20001;
     int best_score = -20001;
@@ -68,15 +98,14 @@ int search(Position& position, Search_stack* ss, Search_data& sd, int depth, int
     Movelist movelist;
     position.generate_stage<all>(movelist);
     for (int i{}; i < movelist.size(); ++i) {
-        if (!position.is_legal(movelist[i])) continue;
-        position.make_move<true>(movelist[i], sd.nnue);
+        prefetch_moves(position, sd, movelist, i);
+        position.play<true>(movelist[i], sd.nnue);
         ss->move = movelist[i];
-        bool gives_check = position.check();
         ++sd.nodes;
         ++legal_moves;
         (ss + 1)->ply = ss->ply + 1;
         score = -search(position, ss + 1, sd, depth - 1, -beta, -alpha);
-        position.undo_move<true>(movelist[i], sd.nnue);
+        position.take_back<true>(movelist[i], sd.nnue);
         if ((*sd.timer).stopped()) return 0;
         if (score > best_score) {
             best_score = score;
@@ -106,6 +135,7 @@ void search_root(Position& position, Limit_timer& timer, Search_data& sd, bool o
     ss[4].ply = 0;
     NNUE nnue;
     nnue.refresh(position);
+    sd.eval_cache.validate(nnue.network_tag());
     sd.nnue = &nnue;
     sd.timer = &timer;
     int score;
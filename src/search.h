@@ -2,6 +2,7 @@
 #define EXOCET_SEARCH
 
 #include "board.h"
+#include "eval_cache.h"
 #include "move.h"
 #include "nnue.h"
 #include "timer.h"
@@ -13,6 +14,8 @@ struct Search_stack {
 
 struct Search_data {
     u64 nodes{};
+    Eval_cache eval_cache;
+    int prefetch_distance = 1; //moves ahead of the one being made whose weight rows are prefetched, plus one, 0 disables
     NNUE* nnue = nullptr;
     Limit_timer* timer = nullptr;
     Move pv_table[128][128];
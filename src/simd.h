@@ -15,7 +15,9 @@
 #endif
 
 #define I16_STRIDE (BIT_ALIGNMENT / 16)
-#define ALIGNMENT (BIT_ALIGNMENT / 8)
+#define I32_STRIDE (BIT_ALIGNMENT / 32)
+//shared data is always aligned for the widest register, since kernels for every instruction set work on the same buffers
+#define ALIGNMENT 64
 
 #if defined(__AVX512F__) && defined(__AVX512BW__) && defined(__AVX512DQ__)
 using register_type = __m512i;
@@ -28,6 +30,13 @@ using register_type = __m512i;
 #define register_max_16 _mm512_max_epi16
 #define register_set_16 _mm512_set1_epi16
 #define register_mul_16 _mm512_mullo_epi16
+#define register_srli_16 _mm512_srli_epi16
+#define register_packus_16 _mm512_packus_epi16
+#define register_maddubs_16 _mm512_maddubs_epi16
+#define register_load_i8(weights) _mm512_cvtepi8_epi16(_mm256_load_si256(reinterpret_cast<const __m256i*>(weights)))
+#define register_unpack_lanes(packed) _mm512_permutexvar_epi64(_mm512_setr_epi64(0, 2, 4, 6, 1, 3, 5, 7), packed)
+#define register_set_32 _mm512_set1_epi32
+#define register_positive_mask_32(values) static_cast<unsigned>(_mm512_cmpgt_epi32_mask(values, _mm512_setzero_si512()))
 #elif defined(__AVX2__) || defined(__AVX__)
 using register_type = __m256i;
 #define register_madd_16 _mm256_madd_epi16
@@ -39,10 +48,18 @@ using register_type = __m256i;
 #define register_max_16 _mm256_max_epi16
 #define register_set_16 _mm256_set1_epi16
 #define register_mul_16 _mm256_mullo_epi16
+#define register_srli_16 _mm256_srli_epi16
+#define register_packus_16 _mm256_packus_epi16
+#define register_maddubs_16 _mm256_maddubs_epi16
+#define register_load_i8(weights) _mm256_cvtepi8_epi16(_mm_load_si128(reinterpret_cast<const __m128i*>(weights)))
+#define register_unpack_lanes(packed) _mm256_permute4x64_epi64(packed, 0xD8)
+#define register_set_32 _mm256_set1_epi32
+#define register_positive_mask_32(values) static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(values, _mm256_setzero_si256()))))
 #endif
 
 #ifdef SIMD
-inline i32 register_sum_32(register_type& reg) {
+//static so that every kernel translation unit keeps its own copy built for its own instruction set
+static inline i32 register_sum_32(register_type& reg) {
 #if defined(__AVX512F__) && defined(__AVX512BW__) && defined(__AVX512DQ__)
     const __m256i reduced_8 = _mm256_add_epi32(_mm512_castsi512_si256(reg), _mm512_extracti32x8_epi32(reg, 1));
 #elif defined(__AVX2__) || defined(__AVX__)
@@ -56,4 +73,4 @@ inline i32 register_sum_32(register_type& reg) {
 }
 #endif
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,92 @@
+#include "startup.h"
+#include "timer.h"
+#include "types.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+int startup_bench(int runs) {
+    std::cout << "startup bench is not supported on this platform" << std::endl;
+    return 1;
+}
+
+#else
+
+//resident set size of a process in kilobytes, 0 where /proc is unavailable
+static int resident_kilobytes(pid_t pid) {
+    std::ifstream status("/proc/" + std::to_string(pid) + "/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("VmRSS:", 0) == 0) return std::stoi(line.substr(6));
+    }
+    return 0;
+}
+
+static bool time_startup(double& seconds, int& rss) {
+    int to_child[2];
+    int from_child[2];
+    if (pipe(to_child) != 0 || pipe(from_child) != 0) return false;
+    Timer timer;
+    timer.reset();
+    const pid_t pid = fork();
+    if (pid < 0) return false;
+    if (pid == 0) {
+        dup2(to_child[0], STDIN_FILENO);
+        dup2(from_child[1], STDOUT_FILENO);
+        close(to_child[0]);
+        close(to_child[1]);
+        close(from_child[0]);
+        close(from_child[1]);
+        execl("/proc/self/exe", "exocet", static_cast<char*>(nullptr));
+        _exit(127);
+    }
+    close(to_child[0]);
+    close(from_child[1]);
+    const std::string uci = "uci\n";
+    bool ok = write(to_child[1], uci.data(), uci.size()) == static_cast<ssize_t>(uci.size());
+    std::string output;
+    char buffer[4096];
+    while (ok && output.find("uciok") == std::string::npos) {
+        const ssize_t bytes = read(from_child[0], buffer, sizeof(buffer));
+        if (bytes <= 0) ok = false;
+        else output.append(buffer, bytes);
+    }
+    seconds = timer.elapsed();
+    rss = resident_kilobytes(pid);
+    const std::string quit = "quit\n";
+    if (write(to_child[1], quit.data(), quit.size()) < 0) ok = false;
+    close(to_child[1]);
+    close(from_child[0]);
+    int status;
+    waitpid(pid, &status, 0);
+    return ok;
+}
+
+int startup_bench(int runs) {
+    double total = 0.0;
+    double fastest = 1e9;
+    double slowest = 0.0;
+    int rss = 0;
+    for (int run{}; run < runs; ++run) {
+        double seconds;
+        if (!time_startup(seconds, rss)) {
+            std::cout << "could not start the engine" << std::endl;
+            return 1;
+        }
+        total += seconds;
+        fastest = std::min(fastest, seconds);
+        slowest = std::max(slowest, seconds);
+    }
+    std::cout << "startup mean " << total / runs * 1000 << " ms min " << fastest * 1000 << " ms max " << slowest * 1000 << " ms rss " << rss << " kB over " << runs << " runs" << std::endl;
+    return 0;
+}
+
+#endif
@@ -0,0 +1,7 @@
+#ifndef EXOCET_STARTUP
+#define EXOCET_STARTUP
+
+//starts the engine as a child process the given number of times and reports the time from exec to uciok
+int startup_bench(int runs);
+
+#endif
@@ -1,60 +1,506 @@
+#include "attacks.h"
+#include "bits.h"
+#include "kernels.h"
+#include "lookup.h"
+#include "numa.h"
 #include "perft.h"
 #include "search.h"
 #include "uci.h"
 #include <chrono>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <numeric>
+#include <random>
 #include <sstream>
 #include <thread>
 
 #define VERSION "0.0.0-dev"
 
+const std::array<std::string, 20> bench_fens = {
+    "r3k2r/2pb1ppp/2pp1q2/p7/1nP1B3/1P2P3/P2N1PPP/R2QK2R w KQkq a6 0 14",
+    "4rrk1/2p1b1p1/p1p3q1/4p3/2P2n1p/1P1NR2P/PB3PP1/3R1QK1 b - - 2 24",
+    "r3qbrk/6p1/2b2pPp/p3pP1Q/PpPpP2P/3P1B2/2PB3K/R5R1 w - - 16 42",
+    "6k1/1R3p2/6p1/2Bp3p/3P2q1/P7/1P2rQ1K/5R2 b - - 4 44",
+    "8/8/1p2k1p1/3p3p/1p1P1P1P/1P2PK2/8/8 w - - 3 54",
+    "7r/2p3k1/1p1p1qp1/1P1Bp3/p1P2r1P/P7/4R3/Q4RK1 w - - 0 36",
+    "r1bq1rk1/pp2b1pp/n1pp1n2/3P1p2/2P1p3/2N1P2N/PP2BPPP/R1BQ1RK1 b - - 2 10",
+    "3r3k/2r4p/1p1b3q/p4P2/P2Pp3/1B2P3/3BQ1RP/6K1 w - - 3 87",
+    "2r4r/1p4k1/1Pnp4/3Qb1pq/8/4BpPp/5P2/2RR1BK1 w - - 0 42",
+    "4q1bk/6b1/7p/p1p4p/PNPpP2P/KN4P1/3Q4/4R3 b - - 0 37",
+    "2q3r1/1r2pk2/pp3pp1/2pP3p/P1Pb1BbP/1P4Q1/R3NPP1/4R1K1 w - - 2 34",
+    "1r2r2k/1b4q1/pp5p/2pPp1p1/P3Pn2/1P1B1Q1P/2R3P1/4BR1K b - - 1 37",
+    "r3kbbr/pp1n1p1P/3ppnp1/q5N1/1P1pP3/P1N1B3/2P1QP2/R3KB1R b KQkq b3 0 17",
+    "8/6pk/2b1Rp2/3r4/1R1B2PP/P5K1/8/2r5 b - - 16 42",
+    "1r4k1/4ppb1/2n1b1qp/pB4p1/1n1BP1P1/7P/2PNQPK1/3RN3 w - - 8 29",
+    "8/p2B4/PkP5/4p1pK/4Pb1p/5P2/8/8 w - - 29 68",
+    "3r4/ppq1ppkp/4bnp1/2pN4/2P1P3/1P4P1/PQ3PBP/R4K2 b - - 2 20",
+    "5rr1/4n2k/4q2P/P1P2n2/3B1p2/4pP2/2N1P3/1RR1K2Q w - - 1 49",
+    "1r5k/2pq2p1/3p3p/p1pP4/4QP2/PP1R3P/6PK/8 w - - 1 51",
+    "q5k1/5ppp/1r3bn1/1B6/P1N2P2/BQ2P1P1/5K1P/8 b - - 2 34"
+};
+
+bool load_fen_string(Position& position, const std::string& fen) {
+    std::string token;
+    std::vector<std::string> tokens;
+    std::istringstream parser(fen);
+    while (parser >> token) {tokens.push_back(token);}
+    if (tokens.size() < 6) return false;
+    return position.load_fen(tokens[0], tokens[1], tokens[2], tokens[3], tokens[4], tokens[5]);
+}
+
+std::string join_tokens(std::vector<std::string>::iterator begin, std::vector<std::string>::iterator end) {
+    std::string joined;
+    for (auto iter = begin; iter != end; ++iter) {
+        if (iter != begin) joined += ' ';
+        joined += *iter;
+    }
+    return joined;
+}
+
+//compares both formats on local copies of the published net, so that nothing is published for the report
+void report_quantization_error() {
+    Position check_position;
+    Network reference = *current_network();
+    reference.format = format_i16;
+    Network quantized = reference;
+    quantized.format = format_i8;
+    if (!quantized.quantized) quantized.quantize();
+    int total_error{};
+    int max_error{};
+    for (const std::string& fen : bench_fens) {
+        load_fen_string(check_position, fen);
+        const Eval_position position = make_eval_position(check_position);
+        int error = std::abs(evaluate_position(position, quantized) - evaluate_position(position, reference));
+        total_error += error;
+        max_error = std::max(max_error, error);
+    }
+    std::cout << "info string int8 eval delta mean " << total_error / 2.0 / bench_fens.size() << " cp max " << max_error / 2.0 << " cp over " << bench_fens.size() << " positions" << std::endl;
+}
+
+void report_small_net_error() {
+    Position check_position;
+    NNUE nnue;
+    int total_error{};
+    int max_error{};
+    for (const std::string& fen : bench_fens) {
+        load_fen_string(check_position, fen);
+        nnue.refresh(check_position);
+        int error = std::abs(nnue.evaluate_small(check_position.side_to_move) - nnue.evaluate(check_position.side_to_move));
+        total_error += error;
+        max_error = std::max(max_error, error);
+    }
+    std::cout << "info string small net eval delta mean " << total_error / 2.0 / bench_fens.size() << " cp max " << max_error / 2.0 << " cp over " << bench_fens.size() << " positions" << std::endl;
+}
+
 void Uci::handle_bench() {
-    const static std::array<std::string, 20> fens = {
-        "r3k2r/2pb1ppp/2pp1q2/p7/1nP1B3/1P2P3/P2N1PPP/R2QK2R w KQkq a6 0 14",
-        "4rrk1/2p1b1p1/p1p3q1/4p3/2P2n1p/1P1NR2P/PB3PP1/3R1QK1 b - - 2 24",
-        "r3qbrk/6p1/2b2pPp/p3pP1Q/PpPpP2P/3P1B2/2PB3K/R5R1 w - - 16 42",
-        "6k1/1R3p2/6p1/2Bp3p/3P2q1/P7/1P2rQ1K/5R2 b - - 4 44",
-        "8/8/1p2k1p1/3p3p/1p1P1P1P/1P2PK2/8/8 w - - 3 54",
-        "7r/2p3k1/1p1p1qp1/1P1Bp3/p1P2r1P/P7/4R3/Q4RK1 w - - 0 36",
-        "r1bq1rk1/pp2b1pp/n1pp1n2/3P1p2/2P1p3/2N1P2N/PP2BPPP/R1BQ1RK1 b - - 2 10",
-        "3r3k/2r4p/1p1b3q/p4P2/P2Pp3/1B2P3/3BQ1RP/6K1 w - - 3 87",
-        "2r4r/1p4k1/1Pnp4/3Qb1pq/8/4BpPp/5P2/2RR1BK1 w - - 0 42",
-        "4q1bk/6b1/7p/p1p4p/PNPpP2P/KN4P1/3Q4/4R3 b - - 0 37",
-        "2q3r1/1r2pk2/pp3pp1/2pP3p/P1Pb1BbP/1P4Q1/R3NPP1/4R1K1 w - - 2 34",
-        "1r2r2k/1b4q1/pp5p/2pPp1p1/P3Pn2/1P1B1Q1P/2R3P1/4BR1K b - - 1 37",
-        "r3kbbr/pp1n1p1P/3ppnp1/q5N1/1P1pP3/P1N1B3/2P1QP2/R3KB1R b KQkq b3 0 17",
-        "8/6pk/2b1Rp2/3r4/1R1B2PP/P5K1/8/2r5 b - - 16 42",
-        "1r4k1/4ppb1/2n1b1qp/pB4p1/1n1BP1P1/7P/2PNQPK1/3RN3 w - - 8 29",
-        "8/p2B4/PkP5/4p1pK/4Pb1p/5P2/8/8 w - - 29 68",
-        "3r4/ppq1ppkp/4bnp1/2pN4/2P1P3/1P4P1/PQ3PBP/R4K2 b - - 2 20",
-        "5rr1/4n2k/4q2P/P1P2n2/3B1p2/4pP2/2N1P3/1RR1K2Q w - - 1 49",
-        "1r5k/2pq2p1/3p3p/p1pP4/4QP2/PP1R3P/6PK/8 w - - 1 51",
-        "q5k1/5ppp/1r3bn1/1B6/P1N2P2/BQ2P1P1/5K1P/8 b - - 2 34"
-    };
     u64 total_nodes = 0;
     double total_time = 0.0;
-    std::string token;
-    std::vector<std::string> tokens;
-    Search_data sd;
-    for (std::string fen : fens) {
-        tokens.clear();
-        std::istringstream parser(fen);
-        while (parser >> token) {tokens.push_back(token);}
+    Search_data& sd = search_data;
+    sd.nodes = 0;
+    sd.eval_cache.clear();
+    sd.eval_cache.probes = sd.eval_cache.hits = 0;
+    for (std::string fen : bench_fens) {
         timer.reset(0, 0, 0, 0, 2);
-        position.load_fen(tokens[0], tokens[1], tokens[2], tokens[3], tokens[4], tokens[5]);
+        load_fen_string(position, fen);
         search_root(position, timer, sd, false);
         total_nodes += sd.nodes;
         total_time += timer.elapsed();
     }
+    std::cout << "info string kernels " << kernels->name << '\n';
+    std::cout << "info string eval cache hitrate " << sd.eval_cache.hit_rate() << "%\n";
     std::cout << total_nodes << " nodes " << static_cast<int>(total_nodes / total_time) << " nps" << std::endl;
 }
 
+//the same maps piece by piece through the magic lookups, what the attack map kernels replace
+static void piece_attack_maps(Position& position, bool side, u64 occ, Attack_maps& maps) {
+    u64 pieces = position.pieces[black_pawn + side];
+    maps.by_type[0] = 0;
+    while (pieces) maps.by_type[0] |= pawn_attacks[side][pop_lsb(pieces)];
+    pieces = position.pieces[black_knight + side];
+    maps.by_type[1] = 0;
+    while (pieces) maps.by_type[1] |= knight_attacks[pop_lsb(pieces)];
+    pieces = position.pieces[black_bishop + side];
+    maps.by_type[2] = 0;
+    while (pieces) maps.by_type[2] |= bishop_attacks(occ, pop_lsb(pieces));
+    pieces = position.pieces[black_rook + side];
+    maps.by_type[3] = 0;
+    while (pieces) maps.by_type[3] |= rook_attacks(occ, pop_lsb(pieces));
+    pieces = position.pieces[black_queen + side];
+    maps.by_type[4] = 0;
+    while (pieces) maps.by_type[4] |= queen_attacks(occ, pop_lsb(pieces));
+    maps.by_type[5] = king_attacks[get_lsb(position.pieces[black_king + side])];
+    maps.all = maps.by_type[0] | maps.by_type[1] | maps.by_type[2] | maps.by_type[3] | maps.by_type[4] | maps.by_type[5];
+}
+
+//keeps the timed loops from being optimized away
+static volatile u64 attack_sink;
+
+//nanoseconds per map over both sides of the bench positions, counting the maps that differ from the per-piece ones,
+//only the union when the maps by piece type are not computed
+template <bool union_only, typename Maps> static double time_attack_maps(std::vector<std::unique_ptr<Position>>& positions, Maps compute, int& mismatches) {
+    constexpr int rounds = 20000;
+    Attack_maps maps;
+    Attack_maps expected;
+    u64 sink{};
+    Timer timer;
+    timer.reset();
+    for (int round{}; round < rounds; ++round) {
+        for (auto& position : positions) {
+            for (bool side : {false, true}) {
+                compute(*position, side, maps);
+                sink += maps.all;
+            }
+        }
+    }
+    const double elapsed = timer.elapsed();
+    attack_sink = sink;
+    mismatches = 0;
+    for (auto& position : positions) {
+        for (bool side : {false, true}) {
+            compute(*position, side, maps);
+            piece_attack_maps(*position, side, position->occupied(), expected);
+            if constexpr (union_only) mismatches += maps.all != expected.all;
+            else mismatches += std::memcmp(&maps, &expected, sizeof(Attack_maps)) != 0;
+        }
+    }
+    return elapsed / (static_cast<double>(rounds) * positions.size() * 2) * 1e9;
+}
+
+void Uci::handle_attackbench() {
+    std::vector<std::unique_ptr<Position>> positions;
+    for (const std::string& fen : bench_fens) {
+        positions.push_back(std::make_unique<Position>());
+        load_fen_string(*positions.back(), fen);
+    }
+    int mismatches;
+    double ns = time_attack_maps<false>(positions, [] (Position& position, bool side, Attack_maps& maps) {piece_attack_maps(position, side, position.occupied(), maps);}, mismatches);
+    std::cout << "info string attack maps per piece " << ns << " ns" << std::endl;
+    ns = time_attack_maps<true>(positions, [] (Position& position, bool side, Attack_maps& maps) {maps.all = side ? position.attacked_squares<true>(position.occupied()) : position.attacked_squares<false>(position.occupied());}, mismatches);
+    std::cout << "info string union only per piece " << ns << " ns mismatches " << mismatches << std::endl;
+    const Kernels* selected = kernels;
+    std::istringstream names(supported_kernels());
+    std::string name;
+    while (names >> name) {
+        select_kernels(name);
+        ns = time_attack_maps<false>(positions, [] (Position& position, bool side, Attack_maps& maps) {position.attack_maps(side, position.occupied(), maps);}, mismatches);
+        std::cout << "info string attack maps " << name << " " << ns << " ns mismatches " << mismatches << std::endl;
+    }
+    kernels = selected;
+}
+
+//perft nodes per second over the bench positions, for one make/undo strategy
+template <bool copy> static double perft_nps(std::vector<std::unique_ptr<Position>>& positions, int depth) {
+    u64 nodes{};
+    Timer timer;
+    timer.reset();
+    for (auto& position : positions) nodes += perft<copy>(*position, depth);
+    return nodes / timer.elapsed();
+}
+
+void Uci::handle_makebench(std::vector<std::string> tokens) {
+    int depth = 4;
+    if (tokens.size() >= 2) {depth = stoi(tokens[1]);}
+    std::vector<std::unique_ptr<Position>> positions;
+    for (const std::string& fen : bench_fens) {
+        positions.push_back(std::make_unique<Position>());
+        load_fen_string(*positions.back(), fen);
+    }
+    //alternating rounds and keeping the best of each, so that both see the same machine load
+    double undo_nps{};
+    double copy_nps{};
+    for (int round{}; round < 3; ++round) {
+        undo_nps = std::max(undo_nps, perft_nps<false>(positions, depth));
+        copy_nps = std::max(copy_nps, perft_nps<true>(positions, depth));
+    }
+    std::cout << "info string perft undo-make " << static_cast<u64>(undo_nps) << " nps copy-make " << static_cast<u64>(copy_nps) << " nps" << std::endl;
+    std::cout << "info string search uses " << (copy_make ? "copy-make" : "undo-make") << '\n';
+    handle_bench();
+}
+
+//nanoseconds per move generated over the bench positions, then perft speed from them
+void Uci::handle_movegenbench() {
+    constexpr int rounds = 20000;
+    std::vector<std::unique_ptr<Position>> positions;
+    for (const std::string& fen : bench_fens) {
+        positions.push_back(std::make_unique<Position>());
+        load_fen_string(*positions.back(), fen);
+    }
+    Movelist movelist;
+    u64 moves{};
+    Timer timer;
+    timer.reset();
+    for (int round{}; round < rounds; ++round) {
+        for (auto& position : positions) {
+            position->invalidate_check_info(); //the pins are part of generating
+            position->generate_stage<all>(movelist);
+            moves += movelist.size();
+        }
+    }
+    const double elapsed = timer.elapsed();
+    std::cout << "info string serializer " << (kernels->add_targets ? "avx512 compress" : "scalar") << '\n';
+    std::cout << "info string movegen " << elapsed / moves * 1e9 << " ns per move, " << elapsed / (static_cast<double>(rounds) * positions.size()) * 1e9 << " ns per position" << std::endl;
+    std::cout << "info string perft " << static_cast<u64>(perft_nps<copy_make>(positions, 4)) << " nps" << std::endl;
+}
+
+//every thread searches the bench positions on its own, so the only shared data is the network
+static double numa_bench_nps(int threads, bool pinned) {
+    std::vector<u64> nodes(threads);
+    std::vector<std::thread> workers;
+    Timer timer;
+    timer.reset();
+    for (int thread{}; thread < threads; ++thread) {
+        workers.emplace_back([thread, pinned, &nodes] {
+            if (pinned) bind_to_numa_node(thread % numa_nodes().size());
+            //allocated after pinning so that the search state is local to the thread's node
+            auto position = std::make_unique<Position>();
+            auto sd = std::make_unique<Search_data>();
+            Limit_timer limit;
+            for (const std::string& fen : bench_fens) {
+                limit.reset(0, 0, 0, 0, 2);
+                load_fen_string(*position, fen);
+                search_root(*position, limit, *sd, false);
+            }
+            nodes[thread] = sd->nodes;
+        });
+    }
+    for (std::thread& worker : workers) worker.join();
+    return std::accumulate(nodes.begin(), nodes.end(), u64{}) / timer.elapsed();
+}
+
+void Uci::handle_numabench(std::vector<std::string> tokens) {
+    const int max_threads = tokens.size() > 1 ? std::stoi(tokens[1]) : std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "info string numa nodes";
+    for (const Numa_node& node : numa_nodes()) std::cout << ' ' << node.id << ':' << node.cpus.size() << " cpus";
+    std::cout << '\n';
+    for (int threads = 1; threads <= max_threads; threads = threads < max_threads ? std::min(threads * 2, max_threads) : threads + 1) {
+        const double unpinned = numa_bench_nps(threads, false);
+        const double pinned = numa_bench_nps(threads, true);
+        std::cout << "info string threads " << threads << " unpinned " << static_cast<u64>(unpinned) << " nps pinned " << static_cast<u64>(pinned) << " nps" << std::endl;
+    }
+}
+
+constexpr int prefetch_table_rows = 12 * 64 * 16; //inputs of a net with 16 king buckets
+constexpr int prefetch_updates = 1 << 20;
+
+//stand-in for the search work between picking a move and updating the accumulator after it
+static u64 busy_work(u64 state) {
+    for (int step{}; step < 64; ++step) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+    }
+    return state;
+}
+
+//nanoseconds per sub+sub+add update, with the rows of the update distance - 1 ahead prefetched before the work
+static double time_prefetched_updates(const std::vector<i16>& weights, int hidden, const std::vector<int>& rows, int distance, u64& sink) {
+    std::vector<i16> accumulator(hidden);
+    const int row_bytes = hidden * sizeof(i16);
+    Timer timer;
+    timer.reset();
+    for (int update{}; update < prefetch_updates; ++update) {
+        const int ahead = update + distance - 1;
+        if (distance && ahead < prefetch_updates) {
+            for (int i{}; i < 3; ++i) {
+                const char* row = reinterpret_cast<const char*>(weights.data() + static_cast<u64>(rows[ahead * 3 + i]) * hidden);
+                for (int offset{}; offset < row_bytes; offset += 64) prefetch(row + offset);
+            }
+        }
+        sink = busy_work(sink);
+        const i16* sub1 = weights.data() + static_cast<u64>(rows[update * 3]) * hidden;
+        const i16* sub2 = weights.data() + static_cast<u64>(rows[update * 3 + 1]) * hidden;
+        const i16* add = weights.data() + static_cast<u64>(rows[update * 3 + 2]) * hidden;
+        for (int i{}; i < hidden; ++i) accumulator[i] += add[i] - sub1[i] - sub2[i];
+    }
+    const double seconds = timer.elapsed();
+    sink += accumulator[sink % hidden];
+    return seconds / prefetch_updates * 1e9;
+}
+
+//accumulator updates from synthetic bucketed weight tables of several hidden sizes at several prefetch distances
+void Uci::handle_prefetchbench() {
+    constexpr int hidden_sizes[] {64, 256, 512, 1024};
+    constexpr int distances[] {0, 1, 2, 4, 8};
+    std::mt19937 rng(1);
+    std::vector<int> rows(prefetch_updates * 3);
+    for (int& row : rows) row = rng() % prefetch_table_rows;
+    u64 sink = 1;
+    for (int hidden : hidden_sizes) {
+        std::vector<i16> weights(static_cast<u64>(prefetch_table_rows) * hidden);
+        for (i16& weight : weights) weight = rng() % 64 - 32;
+        std::cout << "info string hidden " << hidden << " table " << weights.size() * sizeof(i16) / (1 << 20) << " MB ns per update";
+        for (int distance : distances) std::cout << " distance " << distance << " " << time_prefetched_updates(weights, hidden, rows, distance, sink);
+        std::cout << std::endl;
+    }
+    std::cout << "info string checksum " << sink << std::endl;
+}
+
+//the dense layers evaluated one multiply at a time, the reference every kernel's propagate must match exactly
+static i32 scalar_propagate(const i16* accumulator_us, const i16* accumulator_them, const i16* scale, const Layer_weights& weights) {
+    u8 transformed[hidden_dsize];
+    for (int i = 0; i < hidden_dsize; ++i) {
+        const i32 value = (i < hidden_size ? accumulator_us[i] : accumulator_them[i - hidden_size]) * scale[i % hidden_size];
+        const i32 clipped = std::clamp(value, 0, input_quantization);
+        transformed[i] = (clipped * clipped) >> 8;
+    }
+    std::vector<u8> l1_activated(l1_size);
+    for (int j = 0; j < l1_size; ++j) {
+        i32 sum = weights.l1_bias[j];
+        for (int i = 0; i < hidden_dsize; ++i) sum += transformed[i] * weights.l1_weights[((i / 4) * l1_size + j) * 4 + i % 4];
+        l1_activated[j] = std::clamp(sum >> layer_shift, 0, 127);
+    }
+    i32 output = weights.output_bias;
+    for (int j = 0; j < l2_size; ++j) {
+        i32 sum = weights.l2_bias[j];
+        for (int i = 0; i < l1_size; ++i) sum += l1_activated[i] * weights.l2_weights[((i / 4) * l2_size + j) * 4 + i % 4];
+        output += std::clamp(sum >> layer_shift, 0, 127) * weights.output_weights[j];
+    }
+    return output;
+}
+
+//propagate of every supported kernel against the scalar reference, on random accumulators, scales and dense layers
+void Uci::handle_propagatechecks(std::vector<std::string> tokens) {
+    if (l1_size == 0) {
+        std::cout << "info string propagatechecks needs a build with L1_SIZE and L2_SIZE set" << std::endl;
+        return;
+    }
+    int count = 10000;
+    if (tokens.size() >= 2) {count = stoi(tokens[1]);}
+    std::mt19937 rng(1);
+    auto layers = std::make_unique<Dense_layers>();
+    auto accumulators = std::make_unique<Accumulator<hidden_size>>();
+    alignas(ALIGNMENT) std::array<i16, hidden_size> scale;
+    const Kernels* selected = kernels;
+    const std::string names_list = supported_kernels();
+    std::vector<u64> mismatches(std::count(names_list.begin(), names_list.end(), ' ') + 1);
+    for (int check{}; check < count; ++check) {
+        //a new set of weights every so often, the accumulators every time with about half of the activations clipped to zero
+        if (check % 100 == 0) {
+            for (i8& weight : layers->l1_weights) weight = static_cast<i8>(rng() % 256 - 128);
+            for (i32& bias : layers->l1_bias) bias = static_cast<i32>(rng() % 8192) - 4096;
+            for (i8& weight : layers->l2_weights) weight = static_cast<i8>(rng() % 256 - 128);
+            for (i32& bias : layers->l2_bias) bias = static_cast<i32>(rng() % 8192) - 4096;
+            for (i8& weight : layers->output_weights) weight = static_cast<i8>(rng() % 256 - 128);
+            layers->output_bias = static_cast<i32>(rng() % 8192) - 4096;
+            for (i16& value : scale) value = static_cast<i16>(check % 200 == 0 ? 1 : rng() % 4 + 1);
+        }
+        for (i16& value : accumulators->black) value = static_cast<i16>(rng() % 256) - 64;
+        for (i16& value : accumulators->white) value = static_cast<i16>(rng() % 256) - 64;
+        const Layer_weights weights{layers->l1_weights.data(), layers->l1_bias.data(), layers->l2_weights.data(), layers->l2_bias.data(), layers->output_weights.data(), layers->output_bias};
+        const i32 expected = scalar_propagate(accumulators->white.data(), accumulators->black.data(), scale.data(), weights);
+        std::istringstream names(names_list);
+        std::string name;
+        for (int level{}; names >> name; ++level) {
+            select_kernels(name);
+            if (kernels->propagate(accumulators->white.data(), accumulators->black.data(), scale.data(), weights) != expected) ++mismatches[level];
+        }
+    }
+    kernels = selected;
+    std::istringstream names(names_list);
+    std::string name;
+    for (int level{}; names >> name; ++level) std::cout << "info string propagate " << name << " checks " << count << " mismatches " << mismatches[level] << std::endl;
+}
+
+constexpr int slider_occupancies = 1 << 16;
+
+//independent lookups measure throughput, lookups whose square depends on the last result measure latency
+template <bool dependent> static double time_slider_lookups(u64 (*attacks)(u64, int), const std::vector<u64>& occupancies, const std::vector<int>& squares, u64& sink) {
+    constexpr int rounds = 64;
+    Timer timer;
+    timer.reset();
+    u64 total = sink;
+    for (int round{}; round < rounds; ++round) {
+        for (int i{}; i < slider_occupancies; ++i) {
+            const int square = dependent ? (squares[i] ^ static_cast<int>(total)) & 63 : squares[i];
+            total += attacks(occupancies[i], square);
+        }
+    }
+    const double seconds = timer.elapsed();
+    sink = total;
+    return seconds / (static_cast<double>(slider_occupancies) * rounds) * 1e9;
+}
+
+//the slider attack lookups of the backend this binary was built with, on random occupancies and in perft
+void Uci::handle_sliderbench() {
+    std::mt19937_64 rng(1);
+    std::vector<u64> occupancies(slider_occupancies);
+    std::vector<int> squares(slider_occupancies);
+    for (int i{}; i < slider_occupancies; ++i) {
+        occupancies[i] = rng() & rng(); //a quarter of the squares, about a middlegame's worth
+        squares[i] = rng() & 63;
+    }
+    u64 sink{};
+    std::cout << "info string slider backend " << slider_backend << '\n';
+    std::cout << "info string rook throughput " << time_slider_lookups<false>(rook_attacks, occupancies, squares, sink) << " ns latency " << time_slider_lookups<true>(rook_attacks, occupancies, squares, sink) << " ns\n";
+    std::cout << "info string bishop throughput " << time_slider_lookups<false>(bishop_attacks, occupancies, squares, sink) << " ns latency " << time_slider_lookups<true>(bishop_attacks, occupancies, squares, sink) << " ns\n";
+    Position kiwipete;
+    kiwipete.load_fen("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R", "w", "KQkq", "-", "0", "1");
+    Timer timer;
+    timer.reset();
+    const u64 nodes = perft(kiwipete, 5);
+    const double elapsed = timer.elapsed();
+    std::cout << "info string kiwipete perft 5 nodes " << nodes << " time " << static_cast<int>(elapsed * 1000) << " nps " << static_cast<u64>(nodes / elapsed) << " checksum " << sink << std::endl;
+}
+
+void Uci::handle_evalfens(std::vector<std::string> tokens) {
+    if (tokens.size() < 2) {
+        std::cout << "info string usage: evalfens <fen file> [output file]" << std::endl;
+        return;
+    }
+    std::ifstream fin(tokens[1]);
+    if (!fin) {
+        std::cout << "info string error could not open " << tokens[1] << std::endl;
+        return;
+    }
+    std::vector<Eval_position> positions;
+    std::vector<std::string> fens;
+    Position parse_position;
+    std::string line;
+    int skipped{};
+    while (std::getline(fin, line)) {
+        if (!load_fen_string(parse_position, line)) {
+            ++skipped;
+            continue;
+        }
+        positions.push_back(make_eval_position(parse_position));
+        if (tokens.size() > 2) fens.push_back(line);
+    }
+    std::vector<i32> single(positions.size());
+    std::vector<i32> batched(positions.size());
+    Timer timer;
+    timer.reset();
+    for (u64 i{}; i < positions.size(); ++i) single[i] = evaluate_position(positions[i]);
+    const double single_time = timer.elapsed();
+    timer.reset();
+    evaluate_batch(positions.data(), positions.size(), batched.data());
+    const double batched_time = timer.elapsed();
+    const u64 mismatches = positions.size() - std::inner_product(single.begin(), single.end(), batched.begin(), u64{}, std::plus<>(), std::equal_to<>());
+    std::cout << "info string evaluated " << positions.size() << " positions, skipped " << skipped << " lines\n";
+    std::cout << "info string single " << static_cast<u64>(positions.size() / single_time) << " evals/s batched " << static_cast<u64>(positions.size() / batched_time) << " evals/s mismatches " << mismatches << std::endl;
+    if (tokens.size() > 2) {
+        std::ofstream fout(tokens[2]);
+        for (u64 i{}; i < positions.size(); ++i) fout << fens[i] << " | " << batched[i] / 2 << '\n';
+        if (!fout) std::cout << "info string error could not write " << tokens[2] << std::endl;
+    }
+}
+
+void Uci::handle_exportnet(std::vector<std::string> tokens) {
+    if (tokens.size() < 2) {
+        std::cout << "info string usage: exportnet <file>" << std::endl;
+        return;
+    }
+    export_network(join_tokens(tokens.begin() + 1, tokens.end()));
+}
+
 void Uci::handle_go(std::vector<std::string> tokens) {
-    Search_data sd;
+    Search_data& sd = search_data;
+    sd.nodes = 0;
+    sd.eval_cache.probes = sd.eval_cache.hits = 0;
     if (std::find(tokens.begin(), tokens.end(), "infinite") != tokens.end()) {
         timer.reset();
-        std::thread search_thread{search_root, std::ref(position), std::ref(timer), std::ref(sd), true};
-        search_thread.detach();
+        start_search();
         return;
     }
     int movetime = 0;
@@ -89,7 +535,26 @@ void Uci::handle_go(std::vector<std::string> tokens) {
         movetime = std::max(1, movetime);
     }
     timer.reset(calculate ? std::max(1, std::min(mytime * 3 / 4, 4 * movetime)) : movetime, calculate ? movetime : 0, nodes, 0, depth);
-    std::thread search_thread{search_root, std::ref(position), std::ref(timer), std::ref(sd), true};
+    start_search();
+}
+
+void Uci::start_search() {
+    if (pending_eval_cache >= 0) {
+        search_data.eval_cache.resize(pending_eval_cache);
+        pending_eval_cache = -1;
+    }
+    //engines started side by side are spread over the nodes by the scheduler, so a search is pinned to the node
+    //this process was running on rather than to a fixed one, and its search data is moved there the first time
+    const bool pin = numa_pinning;
+    const bool move_data = pin && search_node < 0;
+    if (move_data) search_node = current_numa_node();
+    const int node = search_node;
+    searching = true;
+    std::thread search_thread{[this, pin, move_data, node] {
+        if (pin && bind_to_numa_node(node) && move_data) search_data.eval_cache.reallocate();
+        search_root(position, timer, search_data, true);
+        searching = false;
+    }};
     search_thread.detach();
 }
 
@@ -108,6 +573,28 @@ void Uci::handle_perft(std::vector<std::string> tokens) {
     std::cout << "info nodes " << result << " time " << static_cast<int>(elapsed * 1000) << " nps " << static_cast<int>(result / elapsed) << std::endl;
 }
 
+void Uci::handle_perftchecks(std::vector<std::string> tokens) {
+    int depth = 1;
+    if (tokens.size() >= 2) {depth = stoi(tokens[1]);}
+    u64 checks{};
+    u64 mismatches{};
+    u64 result = perft_checks(position, depth, checks, mismatches);
+    std::cout << "info nodes " << result << " checks " << checks << " mismatches " << mismatches << std::endl;
+}
+
+void Uci::handle_fuzzlegality(std::vector<std::string> tokens) {
+    u64 pairs = 1000000;
+    if (tokens.size() >= 2) {pairs = stoull(tokens[1]);}
+    u64 tested{};
+    u64 mismatches{};
+    Position start;
+    for (u64 seed{}; seed < bench_fens.size(); ++seed) {
+        load_fen_string(start, bench_fens[seed]);
+        tested += fuzz_legality(start, pairs / bench_fens.size(), seed, mismatches);
+    }
+    std::cout << "info pairs " << tested << " mismatches " << mismatches << std::endl;
+}
+
 void Uci::handle_perftsplit(std::vector<std::string> tokens) {
     int depth = 1;
     if (tokens.size() >= 2) {depth = stoi(tokens[1]);}
@@ -139,6 +626,68 @@ void Uci::handle_quit() {
     std::this_thread::sleep_for(std::chrono::milliseconds(100));
 }
 
+void Uci::handle_reloadnet() {
+    const bool reloaded = reload_network();
+    if (reloaded && current_network()->source == "<default>") std::cout << "info string loaded net version " << current_network()->version << " from the embedded net" << std::endl;
+}
+
+void Uci::handle_repetitionchecks(std::vector<std::string> tokens) {
+    u64 count = 1000000;
+    if (tokens.size() >= 2) {count = stoull(tokens[1]);}
+    u64 tested{};
+    u64 found{};
+    u64 missed{};
+    u64 extra{};
+    Position start;
+    for (u64 seed{}; seed < bench_fens.size(); ++seed) {
+        load_fen_string(start, bench_fens[seed]);
+        tested += check_repetitions(start, count / bench_fens.size(), seed, found, missed, extra);
+    }
+    std::cout << "info positions " << tested << " cuckoo moves " << cuckoo_count() << " repetitions " << found << " missed " << missed << " illegal " << extra << std::endl;
+}
+
+void Uci::handle_setoption(std::vector<std::string> tokens) {
+    auto name_iter = std::find(tokens.begin(), tokens.end(), "name");
+    auto value_iter = std::find(tokens.begin(), tokens.end(), "value");
+    if (name_iter == tokens.end() || value_iter == tokens.end()) return;
+    std::string name = join_tokens(name_iter + 1, value_iter);
+    std::string value = join_tokens(value_iter + 1, tokens.end());
+    if (name == "EvalFile") {
+        if (value.empty() || value == "<default>") {
+            if (load_default()) std::cout << "info string loaded net version " << current_network()->version << " from the embedded net" << std::endl;
+        } else {
+            load_from_file(value);
+        }
+    }
+    if (name == "EvalCache") {
+        //a running search probes the cache, so it is only resized once the search has finished
+        if (searching) pending_eval_cache = std::max(0, std::stoi(value));
+        else search_data.eval_cache.resize(std::stoi(value));
+    }
+    if (name == "NumaPinning") {
+        numa_pinning = value == "true";
+    }
+    if (name == "PrefetchDistance") {
+        search_data.prefetch_distance = std::clamp(std::stoi(value), 0, 8);
+    }
+    if (name == "SmallNet") {
+        if (value == "true") {
+            if (set_small_net(true)) report_small_net_error();
+            else std::cout << "info string error the small net needs the single layer architecture" << std::endl;
+        } else if (value == "false") {
+            set_small_net(false);
+        }
+    }
+    if (name == "NetFormat") {
+        if (value == "i8") {
+            set_net_format(format_i8);
+            report_quantization_error();
+        } else if (value == "i16") {
+            set_net_format(format_i16);
+        }
+    }
+}
+
 void Uci::handle_stop() {
     timer.stop = true;
     std::this_thread::sleep_for(std::chrono::milliseconds(100));
@@ -149,6 +698,13 @@ void Uci::handle_uci() {
     std::cout << "id author Kyle Zhang\n";
     std::cout << "option name Hash type spin default 1 min 1 max 1048576\n";
     std::cout << "option name Threads type spin default 1 min 1 max 1\n";
+    std::cout << "option name EvalFile type string default <default>\n";
+    std::cout << "option name EvalCache type spin default 1 min 0 max 1024\n";
+    std::cout << "option name NetFormat type combo default i16 var i16 var i8\n";
+    std::cout << "option name SmallNet type check default false\n";
+    std::cout << "option name PrefetchDistance type spin default 1 min 0 max 8\n";
+    std::cout << "option name NumaPinning type check default false\n";
+    std::cout << "info string kernels " << kernels->name << '\n';
     std::cout << "uciok\n";
     std::cout << std::flush;
 }
@@ -2,26 +2,52 @@
 #define PEACEKEEPER_UCI
 
 #include "board.h"
+#include "search.h"
 #include "timer.h"
+#include <atomic>
 #include <string>
 #include <vector>
 
 class Uci {
     Position position;
     Limit_timer timer;
+    Search_data search_data; //outlives the detached search thread
+    std::atomic<bool> searching{false};
+    int pending_eval_cache = -1; //a size set during a search, applied before the next one
+    bool numa_pinning = false;
+    int search_node = -1; //the node pinned searches run on and their search data lives on, once one has run
+    void start_search();
 
 public:
+    void handle_attackbench();
     void handle_bench();
+    void handle_evalfens(std::vector<std::string> tokens);
+    void handle_exportnet(std::vector<std::string> tokens);
+    void handle_fuzzlegality(std::vector<std::string> tokens);
     void handle_go(std::vector<std::string> tokens);
     void handle_isready();
+    void handle_makebench(std::vector<std::string> tokens);
+    void handle_movegenbench();
+    void handle_numabench(std::vector<std::string> tokens);
     void handle_perft(std::vector<std::string> tokens);
+    void handle_perftchecks(std::vector<std::string> tokens);
     void handle_perftsplit(std::vector<std::string> tokens);
     void handle_position(std::vector<std::string> tokens);
+    void handle_prefetchbench();
+    void handle_propagatechecks(std::vector<std::string> tokens);
     void handle_quit();
+    void handle_reloadnet();
+    void handle_repetitionchecks(std::vector<std::string> tokens);
+    void handle_setoption(std::vector<std::string> tokens);
+    void handle_sliderbench();
     void handle_stop();
     void handle_uci();
 };
 
+bool load_fen_string(Position& position, const std::string& fen);
+std::string join_tokens(std::vector<std::string>::iterator begin, std::vector<std::string>::iterator end);
+void report_quantization_error();
+void report_small_net_error();
 void print_score(int score);
 void print_pv(Move pv[]);
 void print_info(int score, int depth, u64 nodes, int nps, int time, Move pv[]);
@@ -148,4 +148,9 @@ const u64 zobrist_castling[65] = {
     0,
 };
 
+//key of a castling rights mask, bit i standing for the rook on a8, h8, a1 and h1 in that order
+inline u64 castling_key(int rights) {
+    return (rights & 1 ? zobrist_castling[0] : 0) ^ (rights & 2 ? zobrist_castling[7] : 0) ^ (rights & 4 ? zobrist_castling[56] : 0) ^ (rights & 8 ? zobrist_castling[63] : 0);
+}
+
 #endif